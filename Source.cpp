@@ -7,6 +7,55 @@
 #include<cstring>
 #include<string>
 #include <fstream>
+#include <limits>
+#include <iomanip>
+#include <cstdint>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <sstream>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <tuple>
+#include <list>
+#include <map>
+#include <set>
+#include <chrono>
+#include <cmath>
+#include <cerrno>
+#include <random>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <immintrin.h>
+#define STREAMVBYTE_SIMD 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#define ATTRIBUTE_SCAN_SIMD 1
+#endif
 
 using namespace std;
 
@@ -27,29 +76,469 @@ const char* RelationshipNames[] = {
     "Academic Advising"
 };
 
+const uint8_t NO_ROLE = 0xFF;
+const uint32_t NO_ATTRIBUTE = numeric_limits<uint32_t>::max();
+
+// Interns role and interest strings; every distinct string is stored once.
+class AttributeDictionary {
+
+private:
+    vector<string> strings;
+    unordered_map<string, uint32_t> ids;
+
+public:
+    uint32_t intern(const string& value)
+    {
+        auto it = ids.find(value);
+        if (it != ids.end())
+        {
+            return it->second;
+        }
+        uint32_t id = static_cast<uint32_t>(strings.size());
+        strings.push_back(value);
+        ids[value] = id;
+        return id;
+    }
+
+    uint32_t find(const string& value) const
+    {
+        auto it = ids.find(value);
+        return it == ids.end() ? NO_ATTRIBUTE : it->second;
+    }
+
+    const string& get(uint32_t id) const
+    {
+        return strings[id];
+    }
+
+    size_t size() const
+    {
+        return strings.size();
+    }
+
+    size_t getMemoryUsage() const
+    {
+        size_t bytes = strings.capacity() * sizeof(string);
+        for (const auto& value : strings)
+        {
+            bytes += value.capacity() + sizeof(pair<const string, uint32_t>) + sizeof(void*);
+        }
+        return bytes;
+    }
+
+    void clear()
+    {
+        strings.clear();
+        ids.clear();
+    }
+};
+
+// Node attributes stored column-wise by node id: the name, a one-byte role code and
+// a slice of one shared interest array, with roles and interests pointing into a
+// shared dictionary. A slice is rewritten in place when the new list fits and is
+// appended otherwise; the array is compacted once more than half of it is stale.
+class NodeAttributeStore {
+
+private:
+    AttributeDictionary dictionary;
+    vector<string> names;
+    vector<uint32_t> roleNames;
+    vector<uint8_t> roleCodes;
+    vector<uint32_t> interestStarts;
+    vector<uint32_t> interestCounts;
+    vector<uint32_t> interestIds;
+    size_t staleInterests = 0;
+    size_t rowWiseBytes = 0;
+
+    static size_t rowWiseSize(const string& role, const vector<string>& interests)
+    {
+        size_t bytes = sizeof(string) + role.capacity() + sizeof(vector<string>);
+        for (const auto& interest : interests)
+        {
+            bytes += sizeof(string) + interest.capacity();
+        }
+        return bytes;
+    }
+
+    void replaceInterests(uint32_t id, const vector<uint32_t>& ids)
+    {
+        if (ids.size() > interestCounts[id])
+        {
+            staleInterests += interestCounts[id];
+            interestStarts[id] = static_cast<uint32_t>(interestIds.size());
+            interestIds.insert(interestIds.end(), ids.begin(), ids.end());
+        }
+        else
+        {
+            staleInterests += interestCounts[id] - ids.size();
+            copy(ids.begin(), ids.end(), interestIds.begin() + interestStarts[id]);
+        }
+        interestCounts[id] = static_cast<uint32_t>(ids.size());
+
+        if (staleInterests > interestIds.size() / 2)
+        {
+            vector<uint32_t> compacted;
+            compacted.reserve(interestIds.size() - staleInterests);
+            for (uint32_t row = 0; row < interestStarts.size(); ++row)
+            {
+                uint32_t start = interestStarts[row];
+                interestStarts[row] = static_cast<uint32_t>(compacted.size());
+                compacted.insert(compacted.end(), interestIds.begin() + start, interestIds.begin() + start + interestCounts[row]);
+            }
+            interestIds.swap(compacted);
+            staleInterests = 0;
+        }
+    }
+
+    const uint32_t* interestsBegin(uint32_t id) const
+    {
+        return interestIds.data() + interestStarts[id];
+    }
+
+    const uint32_t* interestsEnd(uint32_t id) const
+    {
+        return interestIds.data() + interestStarts[id] + interestCounts[id];
+    }
+
+    // Index of the lowest set bit of a non-zero mask.
+    static unsigned lowestSetBit(unsigned mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+    }
+
+    // Appends the ids of rows whose role code equals code to matches.
+    void scanRole(uint8_t code, vector<uint32_t>& matches) const
+    {
+        size_t count = roleCodes.size();
+        size_t i = 0;
+#ifdef ATTRIBUTE_SCAN_SIMD
+        __m128i needle = _mm_set1_epi8(static_cast<char>(code));
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(roleCodes.data() + i));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+            for (; mask != 0; mask &= mask - 1)
+            {
+                matches.push_back(static_cast<uint32_t>(i + lowestSetBit(mask)));
+            }
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            if (roleCodes[i] == code)
+            {
+                matches.push_back(static_cast<uint32_t>(i));
+            }
+        }
+    }
+
+public:
+    // Stores the attributes of node id, growing the columns when id is new.
+    // Returns false when the role column has no code left for a new role.
+    bool set(uint32_t id, const string& name, const string& role, const vector<string>& interests)
+    {
+        uint32_t roleId = dictionary.intern(role);
+        auto roleIt = find(roleNames.begin(), roleNames.end(), roleId);
+        if (roleIt == roleNames.end() && roleNames.size() >= NO_ROLE)
+        {
+            return false;
+        }
+        uint8_t code = static_cast<uint8_t>(roleIt - roleNames.begin());
+        if (roleIt == roleNames.end())
+        {
+            roleNames.push_back(roleId);
+        }
+
+        vector<uint32_t> ids;
+        ids.reserve(interests.size());
+        for (const auto& interest : interests)
+        {
+            ids.push_back(dictionary.intern(interest));
+        }
+
+        if (roleCodes.size() <= id)
+        {
+            names.resize(id + 1);
+            roleCodes.resize(id + 1, NO_ROLE);
+            interestStarts.resize(id + 1, static_cast<uint32_t>(interestIds.size()));
+            interestCounts.resize(id + 1, 0);
+        }
+        if (roleCodes[id] != NO_ROLE)
+        {
+            rowWiseBytes -= rowWiseSize(getRole(id), getInterests(id));
+        }
+        names[id] = name;
+        roleCodes[id] = code;
+        replaceInterests(id, ids);
+        rowWiseBytes += rowWiseSize(role, interests);
+        return true;
+    }
+
+    void remove(uint32_t id)
+    {
+        if (id < roleCodes.size() && roleCodes[id] != NO_ROLE)
+        {
+            rowWiseBytes -= rowWiseSize(getRole(id), getInterests(id));
+            roleCodes[id] = NO_ROLE;
+            string().swap(names[id]);
+            replaceInterests(id, {});
+        }
+    }
+
+    // Empty for ids that were never added or have been removed.
+    const string& getName(uint32_t id) const
+    {
+        static const string none;
+        return id < names.size() ? names[id] : none;
+    }
+
+    const string& getRole(uint32_t id) const
+    {
+        static const string none;
+        return getRoleCode(id) == NO_ROLE ? none : dictionary.get(roleNames[roleCodes[id]]);
+    }
+
+    uint8_t getRoleCode(uint32_t id) const
+    {
+        return id < roleCodes.size() ? roleCodes[id] : NO_ROLE;
+    }
+
+    const vector<uint32_t>& getRoleNames() const
+    {
+        return roleNames;
+    }
+
+    const AttributeDictionary& getDictionary() const
+    {
+        return dictionary;
+    }
+
+    vector<string> getInterests(uint32_t id) const
+    {
+        vector<string> interests;
+        if (id >= interestStarts.size())
+        {
+            return interests;
+        }
+        for (const uint32_t* it = interestsBegin(id); it != interestsEnd(id); ++it)
+        {
+            interests.push_back(dictionary.get(*it));
+        }
+        return interests;
+    }
+
+    // Ids of the nodes with the given role and interest, in id order. An empty
+    // role or interest matches every node.
+    vector<uint32_t> select(const string& role, const string& interest) const
+    {
+        vector<uint32_t> matches;
+        if (role.empty())
+        {
+            for (uint32_t id = 0; id < roleCodes.size(); ++id)
+            {
+                if (roleCodes[id] != NO_ROLE)
+                {
+                    matches.push_back(id);
+                }
+            }
+        }
+        else
+        {
+            uint32_t roleId = dictionary.find(role);
+            auto roleIt = find(roleNames.begin(), roleNames.end(), roleId);
+            if (roleId == NO_ATTRIBUTE || roleIt == roleNames.end())
+            {
+                return matches;
+            }
+            scanRole(static_cast<uint8_t>(roleIt - roleNames.begin()), matches);
+        }
+
+        if (!interest.empty())
+        {
+            uint32_t interestId = dictionary.find(interest);
+            matches.erase(remove_if(matches.begin(), matches.end(),
+                [this, interestId](uint32_t id)
+                {
+                    return interestId == NO_ATTRIBUTE || std::find(interestsBegin(id), interestsEnd(id), interestId) == interestsEnd(id);
+                }),
+                matches.end());
+        }
+        return matches;
+    }
+
+    size_t getMemoryUsage() const
+    {
+        return dictionary.getMemoryUsage() + roleNames.capacity() * sizeof(uint32_t) + roleCodes.capacity()
+            + (interestStarts.capacity() + interestCounts.capacity() + interestIds.capacity()) * sizeof(uint32_t);
+    }
+
+    size_t getRowWiseMemoryUsage() const
+    {
+        return rowWiseBytes;
+    }
+
+    void clear()
+    {
+        dictionary.clear();
+        names.clear();
+        roleNames.clear();
+        roleCodes.clear();
+        interestStarts.clear();
+        interestCounts.clear();
+        interestIds.clear();
+        staleInterests = 0;
+        rowWiseBytes = 0;
+    }
+};
+
+// Name and attributes live in the network's NodeAttributeStore; a node is only a
+// handle to the row it occupies there.
 class Node {
 private:
-    string name;
-    string role;
-    vector<string> interests;
+    const NodeAttributeStore* attributes;
+    uint32_t id;
 public:
-    Node(const string& n, const string& r, const vector<string>& i)
-        : name(n), role(r), interests(i) {}
+    Node(const NodeAttributeStore* a, uint32_t i)
+        : attributes(a), id(i) {}
 
     const string& getName() const {
-        return name;
+        return attributes->getName(id);
+    }
+
+    uint32_t getId() const {
+        return id;
     }
 
     const string& getRole() const {
-        return role;
+        return attributes->getRole(id);
     }
 
-    const vector<string>& getInterests() const {
-        return interests;
+    vector<string> getInterests() const {
+        return attributes->getInterests(id);
     }
 
 };
 
+// Points in time are whole days since 1970-01-01. TIME_MIN and TIME_MAX stand for
+// an open start or end of a validity interval.
+typedef int64_t Timestamp;
+const Timestamp TIME_MIN = numeric_limits<Timestamp>::min();
+const Timestamp TIME_MAX = numeric_limits<Timestamp>::max();
+
+// Parses a "YYYY-MM-DD" date with a year from 0 to 9999; returns false for anything
+// else, including days past the end of the month.
+inline bool parseDate(const string& text, Timestamp& day)
+{
+    static const int64_t daysInMonth[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    istringstream in(text);
+    int64_t year, month, dayOfMonth;
+    char dash1, dash2;
+    string rest;
+    if (!(in >> year >> dash1 >> month >> dash2 >> dayOfMonth) || (in >> rest) || dash1 != '-' || dash2 != '-'
+        || year < 0 || year > 9999 || month < 1 || month > 12 || dayOfMonth < 1)
+    {
+        return false;
+    }
+    bool leapYear = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    if (dayOfMonth > daysInMonth[month - 1] + (month == 2 && leapYear))
+    {
+        return false;
+    }
+
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + dayOfMonth - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    day = era * 146097 + dayOfEra - 719468;
+    return true;
+}
+
+// Formats a day as "YYYY-MM-DD"; open ends format as an empty string.
+inline string formatDate(Timestamp day)
+{
+    if (day == TIME_MIN || day == TIME_MAX)
+    {
+        return "";
+    }
+    day += 719468;
+    int64_t era = (day >= 0 ? day : day - 146096) / 146097;
+    int64_t dayOfEra = day - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t monthIndex = (5 * dayOfYear + 2) / 153;
+    int64_t dayOfMonth = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    int64_t month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    int64_t year = yearOfEra + era * 400 + (month <= 2);
+
+    ostringstream out;
+    out << setfill('0') << setw(4) << year << '-' << setw(2) << month << '-' << setw(2) << dayOfMonth;
+    return out.str();
+}
+
+// Graph file fields are separated by ',' and list items by ';'. Backslashes,
+// both separators and line breaks inside a value are escaped with a backslash.
+inline string escapeField(const string& text)
+{
+    string escaped;
+    for (char c : text)
+    {
+        if (c == '\\' || c == ',' || c == ';')
+        {
+            escaped += '\\';
+        }
+        escaped += c == '\n' ? string("\\n") : string(1, c);
+    }
+    return escaped;
+}
+
+inline string unescapeField(const string& text)
+{
+    string value;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] == '\\' && i + 1 < text.size())
+        {
+            ++i;
+            value += text[i] == 'n' ? '\n' : text[i];
+        }
+        else
+        {
+            value += text[i];
+        }
+    }
+    return value;
+}
+
+// Splits on unescaped delimiters; the parts keep their escapes.
+inline vector<string> splitFields(const string& text, char delimiter)
+{
+    vector<string> parts(1);
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] == '\\' && i + 1 < text.size())
+        {
+            parts.back() += text[i];
+            parts.back() += text[++i];
+        }
+        else if (text[i] == delimiter)
+        {
+            parts.emplace_back();
+        }
+        else
+        {
+            parts.back() += text[i];
+        }
+    }
+    return parts;
+}
+
 class Edge {
 
 private:
@@ -57,9 +546,11 @@ private:
     Node* destination;
     double weight;
     RelationshipType relationshipType;
+    Timestamp validFrom;
+    Timestamp validUntil;
 public:
-    Edge(Node* s, Node* d, double w, RelationshipType rt)
-        : source(s), destination(d), weight(w), relationshipType(rt) {}
+    Edge(Node* s, Node* d, double w, RelationshipType rt, Timestamp from = TIME_MIN, Timestamp until = TIME_MAX)
+        : source(s), destination(d), weight(w), relationshipType(rt), validFrom(from), validUntil(until) {}
 
     Node* getSource() const
     {
@@ -81,6 +572,22 @@ public:
         return relationshipType;
     }
 
+    // The relationship holds from validFrom up to, but not including, validUntil.
+    Timestamp getValidFrom() const
+    {
+        return validFrom;
+    }
+
+    Timestamp getValidUntil() const
+    {
+        return validUntil;
+    }
+
+    bool isTemporal() const
+    {
+        return validFrom != TIME_MIN || validUntil != TIME_MAX;
+    }
+
 };
 
 class Event {
@@ -89,11 +596,15 @@ class Event {
 private:
     string name;
     string date;
+    Timestamp day;
 
 public:
 
     Event(const string& n, const string& d)
-        : name(n), date(d) {}
+        : name(n), date(d), day(TIME_MIN)
+    {
+        parseDate(d, day);
+    }
 
     const string& getName() const
     {
@@ -104,722 +615,8652 @@ public:
     {
         return date;
     }
-};
-
-class SocialNetwork {
-
-private:
-    unordered_map<string, Node*> nodes;
-    vector<Edge*> edges;
-    vector<Event*> events;
-    unordered_map<string, vector<string>> attendance;
-public:
 
-    const unordered_map<string, Node*>& getNodes() const
+    // The parsed date, or TIME_MIN when the date is not in "YYYY-MM-DD" form.
+    Timestamp getDay() const
     {
-        return nodes;
+        return day;
     }
+};
 
-    const vector<Edge*>& getEdges() const
-    {
-        return edges;
-    }
+enum MutationType : uint8_t {
+    MUTATION_ADD_NODE = 1,
+    MUTATION_ADD_EDGE,
+    MUTATION_REMOVE_NODE,
+    MUTATION_REMOVE_EDGE,
+    MUTATION_ADD_EVENT,
+    MUTATION_REMOVE_EVENT,
+    MUTATION_MARK_ATTENDANCE,
+    MUTATION_ADD_TEMPORAL_EDGE
+};
 
-    void addNode(const string& name, const string& role, const vector<string>& interests)
-    {
-        nodes[name] = new Node(name, role, interests);
-    }
+struct MutationRecord {
+    MutationType type;
+    vector<string> strings;
+    double weight = 0.0;
+    int relationshipType = 0;
+};
 
-    void addEdge(const string& source, const string& destination, double weight, RelationshipType relationshipType)
+// Append-only log of graph mutations. Records are framed as
+// [u32 body length][u8 type][u32 string count][u32 length + bytes]...[f64 weight][i32 type]
+// and buffered in memory until a group commit writes the whole batch at once and
+// syncs it to stable storage, so a committed group survives a crash.
+// Segments are numbered files "<base>.wal.<seq>"; a snapshot "<base>.snapshot.<seq>"
+// contains every mutation from the segments up to and including <seq>.
+class MutationLog {
+
+private:
+    string basePath;
+    int segment = -1;
+    uint64_t segmentSequence;
+    string pendingBatch;
+    size_t pendingRecords;
+    size_t groupCommitSize;
+    size_t recordsSinceCompaction;
+
+    static void appendU32(string& out, uint32_t value)
     {
-        if (nodes.find(source) == nodes.end() || nodes.find(destination) == nodes.end())
+        for (int i = 0; i < 4; ++i)
         {
-            cout << "Error: Nodes not found while adding edge.\n";
-            return;
+            out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
         }
-        edges.push_back(new Edge(nodes[source], nodes[destination], weight, relationshipType));
     }
 
-    void removeNode(const string& name)
+    static bool readU32(const string& in, size_t& pos, uint32_t& value)
     {
-        auto it = nodes.find(name);
-
-        if (it != nodes.end())
+        if (pos + 4 > in.size())
         {
-            edges.erase(remove_if(edges.begin(), edges.end(),
-
-                [name](const Edge* edge)
-                {
-                    return edge->getSource()->getName() == name || edge->getDestination()->getName() == name;
-                }),
-                edges.end());
-            delete it->second;
-            nodes.erase(it);
+            return false;
         }
-
-        else
+        value = 0;
+        for (int i = 0; i < 4; ++i)
         {
-            cout << "Error: Node with name '" << name << "' not found.\n";
+            value |= static_cast<uint32_t>(static_cast<unsigned char>(in[pos + i])) << (8 * i);
         }
+        pos += 4;
+        return true;
     }
 
-    void removeEdge(const string& source, const string& destination)
-    {
-        edges.erase(remove_if(edges.begin(), edges.end(),
-
-            [source, destination](const Edge* edge)
-            {
-                return edge->getSource()->getName() == source && edge->getDestination()->getName() == destination;
-            }),
-            edges.end());
-    }
-
-    void displayNodeDetails(const string& nodeName)
+    static int openSegment(const string& path)
     {
-        if (nodes.find(nodeName) == nodes.end())
+#ifdef _WIN32
+        int fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+        if (fd < 0)
         {
-            cerr << "Error: Node not found.\n";
-            return;
+            cerr << "Error: Could not open mutation log " << path << endl;
         }
+        return fd;
+    }
 
-        cout << "Details of " << nodeName << " - Role: " << nodes[nodeName]->getRole()
-            << ", Interests: ";
-
-        for (const auto& interest : nodes[nodeName]->getInterests())
+    static void closeSegment(int fd)
+    {
+        if (fd >= 0)
         {
-            cout << interest << " ";
+#ifdef _WIN32
+            _close(fd);
+#else
+            ::close(fd);
+#endif
         }
+    }
 
-        cout << "\nRelationships: ";
-
-        for (const auto& edge : edges)
+    // Writes all bytes and forces them to disk.
+    static bool writeDurably(int fd, const string& data)
+    {
+        size_t written = 0;
+        while (written < data.size())
         {
-            if (edge->getSource()->getName() == nodeName)
+#ifdef _WIN32
+            int result = _write(fd, data.data() + written, static_cast<unsigned int>(min<size_t>(data.size() - written, 1u << 30)));
+#else
+            ssize_t result = ::write(fd, data.data() + written, data.size() - written);
+            if (result < 0 && errno == EINTR)
             {
-
-                cout << edge->getDestination()->getName() << " (Weight: " << edge->getWeight()
-                    << ", Relationship Type: " << RelationshipNames[edge->getRelationshipType()] << ") ";
+                continue;
             }
-
-            else if (edge->getDestination()->getName() == nodeName)
+#endif
+            if (result <= 0)
             {
-                cout << edge->getSource()->getName() << " (Weight: " << edge->getWeight()
-                    << ", Relationship Type: " << RelationshipNames[edge->getRelationshipType()] << ") ";
+                return false;
             }
-
-
+            written += static_cast<size_t>(result);
         }
-        cout << endl;
+#ifdef _WIN32
+        return _commit(fd) == 0;
+#else
+        return fsync(fd) == 0;
+#endif
+    }
 
+    void encode(MutationType type, const vector<string>& strings, double weight, int relationshipType)
+    {
+        string body;
+        body.push_back(static_cast<char>(type));
+        appendU32(body, static_cast<uint32_t>(strings.size()));
+        for (const auto& value : strings)
+        {
+            appendU32(body, static_cast<uint32_t>(value.size()));
+            body += value;
+        }
+        char weightBytes[sizeof(double)];
+        memcpy(weightBytes, &weight, sizeof(double));
+        body.append(weightBytes, sizeof(double));
+        appendU32(body, static_cast<uint32_t>(relationshipType));
+
+        appendU32(pendingBatch, static_cast<uint32_t>(body.size()));
+        pendingBatch += body;
+        ++pendingRecords;
+        ++recordsSinceCompaction;
+    }
 
+public:
+    MutationLog(const string& base, uint64_t sequence, size_t groupCommit)
+        : basePath(base), segmentSequence(sequence), pendingRecords(0),
+        groupCommitSize(groupCommit), recordsSinceCompaction(0)
+    {
+        segment = openSegment(segmentPath(basePath, segmentSequence));
     }
 
-    void displayAllNodes()
+    ~MutationLog()
     {
+        commit();
+        closeSegment(segment);
+    }
 
-        for (const auto& nodePair : nodes)
+    // Forces the contents of an existing file to disk.
+    static bool syncFile(const string& path)
+    {
+#ifdef _WIN32
+        int fd = _open(path.c_str(), _O_RDWR | _O_BINARY);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+#endif
+        if (fd < 0)
         {
-            displayNodeDetails(nodePair.first);
+            return false;
         }
+        bool synced = writeDurably(fd, "");
+        closeSegment(fd);
+        return synced;
     }
 
-    void visualizeGraph()
+    // Forces the directory entries of the directory holding path to disk, so a
+    // rename into it survives a crash. Windows journals them with the rename itself.
+    static bool syncDirectory(const string& path)
     {
-        cout << "Visualizing Network Graph:\n";
-        queue<Node*> nodeQueue;
-        unordered_map<Node*, bool> visited;
-        for (const auto& nodePair : nodes)
+#ifdef _WIN32
+        return true;
+#else
+        filesystem::path file(path);
+        string directory = file.has_parent_path() ? file.parent_path().string() : string(".");
+        int fd = ::open(directory.c_str(), O_RDONLY);
+        if (fd < 0)
         {
-            Node* currentNode = nodePair.second;
-            nodeQueue.push(currentNode);
-            visited[currentNode] = false;
+            return false;
         }
-        while (!nodeQueue.empty())
-        {
-            Node* currentNode = nodeQueue.front();
-            nodeQueue.pop();
-            if (!visited[currentNode])
-            {
-                visited[currentNode] = true;
-                cout << "Node: " << currentNode->getName() << " (Role: " << currentNode->getRole() << ")\n";
-
-                for (const auto& edge : edges)
-                {
-                    if (edge->getSource() == currentNode)
-                    {
-                        cout << "  -> " << edge->getDestination()->getName()
-                            << " (Weight: " << edge->getWeight()
-                            << ", Relationship Type: " << RelationshipNames[edge->getRelationshipType()] << ")\n";
-                        nodeQueue.push(edge->getDestination());
+        bool synced = fsync(fd) == 0;
+        ::close(fd);
+        return synced;
+#endif
+    }
 
-                    }
+    static string segmentPath(const string& base, uint64_t sequence)
+    {
+        return base + ".wal." + to_string(sequence);
+    }
 
-                    else if (edge->getDestination() == currentNode)
-                    {
+    static string snapshotPath(const string& base, uint64_t sequence)
+    {
+        return base + ".snapshot." + to_string(sequence);
+    }
 
-                        cout << "  <- " << edge->getSource()->getName()
-                            << " (Weight: " << edge->getWeight()
-                            << ", Relationship Type: " << RelationshipNames[edge->getRelationshipType()] << ")\n";
-                        nodeQueue.push(edge->getSource());
+    // Returns the sequence numbers of every file named "<base><suffix><seq>", sorted ascending.
+    static vector<uint64_t> listSequences(const string& base, const string& suffix)
+    {
+        vector<uint64_t> sequences;
+        filesystem::path basePathObj(base);
+        filesystem::path directory = basePathObj.has_parent_path() ? basePathObj.parent_path() : filesystem::path(".");
+        string prefix = basePathObj.filename().string() + suffix;
+        error_code ec;
 
-                    }
+        for (const auto& entry : filesystem::directory_iterator(directory, ec))
+        {
+            string fileName = entry.path().filename().string();
+            if (fileName.size() > prefix.size() && fileName.compare(0, prefix.size(), prefix) == 0)
+            {
+                string digits = fileName.substr(prefix.size());
+                if (all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; }))
+                {
+                    sequences.push_back(stoull(digits));
                 }
             }
         }
+        sort(sequences.begin(), sequences.end());
+        return sequences;
     }
 
-    void findHighestCentrality()
+    static vector<MutationRecord> readSegment(const string& path)
     {
-        unordered_map<string, double> centrality;
-        for (const auto& nodePair : nodes)
-        {
-            string currentNodeName = nodePair.first;
-            centrality[currentNodeName] = 0.0;
+        vector<MutationRecord> records;
+        ifstream inFile(path, ios::binary);
+        string data((istreambuf_iterator<char>(inFile)), istreambuf_iterator<char>());
+        size_t pos = 0;
 
-            queue<string> bfsQueue;
-            unordered_set<string> visited;
-
-
-            bfsQueue.push(currentNodeName);
-            visited.insert(currentNodeName);
-
-            while (!bfsQueue.empty())
+        while (pos < data.size())
+        {
+            uint32_t bodyLength;
+            if (!readU32(data, pos, bodyLength) || pos + bodyLength > data.size() || bodyLength < 1)
             {
+                break; // torn tail from an interrupted write
+            }
 
-                string current = bfsQueue.front();
-                bfsQueue.pop();
+            size_t end = pos + bodyLength;
+            MutationRecord record;
+            record.type = static_cast<MutationType>(static_cast<unsigned char>(data[pos++]));
 
-                for (const auto& edge : edges) {
-                    if (edge->getSource()->getName() == current)
-                    {
-                        string neighbor = edge->getDestination()->getName();
-                        if (visited.find(neighbor) == visited.end()) {
-                            bfsQueue.push(neighbor);
-                            visited.insert(neighbor);
-                            centrality[neighbor] += 1.0;
-                        }
-                    }
+            uint32_t stringCount;
+            bool valid = readU32(data, pos, stringCount);
+            for (uint32_t i = 0; valid && i < stringCount; ++i)
+            {
+                uint32_t length;
+                valid = readU32(data, pos, length) && pos + length <= end;
+                if (valid)
+                {
+                    record.strings.push_back(data.substr(pos, length));
+                    pos += length;
                 }
-
-
             }
 
+            uint32_t relationship;
+            valid = valid && pos + sizeof(double) <= end;
+            if (valid)
+            {
+                memcpy(&record.weight, data.data() + pos, sizeof(double));
+                pos += sizeof(double);
+                valid = readU32(data, pos, relationship) && pos == end;
+            }
+            if (!valid)
+            {
+                break;
+            }
 
+            record.relationshipType = static_cast<int>(relationship);
+            records.push_back(record);
         }
-
-        auto maxCentralityIt = max_element(
-            centrality.begin(),
-            centrality.end(),
-            [](const auto& p1, const auto& p2) { return p1.second < p2.second; });
-
-
-
-        cout << "Individual with the highest communication centrality: "
-            << maxCentralityIt->first
-            << " (Centrality: " << maxCentralityIt->second << ")\n";
-
-
-
+        return records;
     }
 
-    void identifyCollaborationNetworks()
+    void append(MutationType type, const vector<string>& strings, double weight = 0.0, int relationshipType = 0)
     {
-        unordered_map<string, string> community;
-        unordered_map<string, double> communityInternalWeights;
-
-        for (const auto& nodePair : nodes)
+        encode(type, strings, weight, relationshipType);
+        if (pendingRecords >= groupCommitSize)
         {
-            community[nodePair.first] = nodePair.first;
-            communityInternalWeights[nodePair.first] = 0.0;
+            commit();
         }
+    }
 
-        sort(edges.begin(), edges.end(),
-            [](const Edge* e1, const Edge* e2) { return e1->getWeight() > e2->getWeight(); });
-
-        for (const auto& edge : edges)
+    // Buffers every record, then commits at most once for the whole run.
+    void appendRecords(const vector<MutationRecord>& records)
+    {
+        for (const auto& record : records)
         {
-            string sourceCommunity = community[edge->getSource()->getName()];
-            string destCommunity = community[edge->getDestination()->getName()];
-
-            if (sourceCommunity != destCommunity) {
-                double internalWeight = communityInternalWeights[sourceCommunity] +
-                    communityInternalWeights[destCommunity] +
-                    edge->getWeight();
-                double modularityGain = internalWeight - edge->getWeight();
-
-                if (modularityGain > 0) {
-                    communityInternalWeights[sourceCommunity] += edge->getWeight();
-                    communityInternalWeights[destCommunity] += edge->getWeight();
-
-                    for (auto& node : community) {
-                        if (node.second == destCommunity) {
-                            node.second = sourceCommunity;
-                        }
-                    }
-                }
-            }
+            encode(record.type, record.strings, record.weight, record.relationshipType);
+        }
+        if (pendingRecords >= groupCommitSize)
+        {
+            commit();
         }
+    }
 
-        unordered_map<string, vector<string>> communities;
-        for (const auto& node : community)
+    void commit()
+    {
+        if (pendingRecords == 0)
+        {
+            return;
+        }
+        if (segment < 0 || !writeDurably(segment, pendingBatch))
         {
-            communities[node.second].push_back(node.first);
+            cerr << "Error: Could not commit " << pendingRecords << " logged mutation(s) to "
+                << segmentPath(basePath, segmentSequence) << endl;
         }
+        pendingBatch.clear();
+        pendingRecords = 0;
+    }
 
+    // Seals the active segment and starts a new one. Returns the sealed sequence number.
+    uint64_t rotate()
+    {
+        commit();
+        closeSegment(segment);
+        uint64_t sealed = segmentSequence++;
+        segment = openSegment(segmentPath(basePath, segmentSequence));
+        recordsSinceCompaction = 0;
+        return sealed;
+    }
 
-        int communityNumber = 1;
-        for (const auto& comm : communities)
-        {
-            cout << "Community " << communityNumber++ << ": ";
-            for (const auto& member : comm.second)
-            {
-                cout << member << " ";
-            }
+    size_t getRecordsSinceCompaction() const
+    {
+        return recordsSinceCompaction;
+    }
 
+    const string& getBasePath() const
+    {
+        return basePath;
+    }
+};
 
-            cout << endl;
-        }
+const uint32_t SNAPSHOT_SEGMENT_SIZE = 1024;
 
+struct AdjacencyRange {
+    const uint32_t* vertices;
+    const double* weights;
+    const uint8_t* types;
+    uint32_t count;
 
+    uint32_t size() const
+    {
+        return count;
     }
 
-    void determineInfluentialByDegreeCentrality()
+    const uint32_t* begin() const
     {
-        unordered_map<string, int> degreeCentrality;
+        return vertices;
+    }
 
-        for (const auto& edge : edges)
-        {
-            degreeCentrality[edge->getSource()->getName()]++;
-            degreeCentrality[edge->getDestination()->getName()]++;
-        }
+    const uint32_t* end() const
+    {
+        return vertices + count;
+    }
+};
 
-        int maxDegree = 0;
-        vector<string> influentialNodes;
+// Compressed sparse rows for one range of SNAPSHOT_SEGMENT_SIZE vertex ids.
+// Neighbors of each vertex are sorted by id.
+struct CsrSegment {
+    vector<uint32_t> outOffsets;
+    vector<uint32_t> outTargets;
+    vector<double> outWeights;
+    vector<uint8_t> outTypes;
+    vector<uint32_t> inOffsets;
+    vector<uint32_t> inSources;
+    vector<double> inWeights;
+    vector<uint8_t> inTypes;
+};
 
-        for (const auto& node : degreeCentrality)
-        {
+struct VertexChunk {
+    vector<string> names;
+    vector<uint8_t> roleCodes;
+    vector<bool> present;
+};
 
-            if (node.second > maxDegree)
-            {
-                maxDegree = node.second;
-                influentialNodes.clear();
-                influentialNodes.push_back(node.first);
-            }
-            else if (node.second == maxDegree)
-            {
-                influentialNodes.push_back(node.first);
-            }
+// Names, roles and presence of every vertex id. Ids are split into chunks of
+// SNAPSHOT_SEGMENT_SIZE and the name lookup into ID_SHARDS hash shards, so a new
+// version only copies the chunks and shards that changed and shares the rest.
+struct VertexTable {
+    static constexpr uint32_t ID_SHARDS = 256;
 
+    uint32_t vertexCount = 0;
+    vector<string> roleNames;
+    vector<shared_ptr<const VertexChunk>> chunks;
+    vector<shared_ptr<const unordered_map<string, uint32_t>>> idShards;
 
-        }
+    static uint32_t shardOf(const string& name)
+    {
+        return static_cast<uint32_t>(hash<string>()(name) % ID_SHARDS);
+    }
 
-        cout << "Most influential individuals by degree centrality:\n";
-        for (const auto& nodeName : influentialNodes)
-        {
-            cout << nodeName << " (Degree Centrality: " << degreeCentrality[nodeName] << ")\n";
-        }
+    const VertexChunk& chunkOf(uint32_t v) const
+    {
+        return *chunks[v / SNAPSHOT_SEGMENT_SIZE];
     }
-    
-    void determineInfluentialByBetweennessCentrality()
+
+    bool isPresent(uint32_t v) const
     {
-        unordered_map<string, double> betweennessCentrality;
+        return chunkOf(v).present[v % SNAPSHOT_SEGMENT_SIZE];
+    }
 
-        for (const auto& nodePair : nodes)
-        {
-            const string& source = nodePair.first;
+    const string& getName(uint32_t v) const
+    {
+        return chunkOf(v).names[v % SNAPSHOT_SEGMENT_SIZE];
+    }
 
-            unordered_map<string, int> distance;
-            unordered_map<string, int> numShortestPaths;
-            unordered_map<string, vector<string>> predecessors;
+    uint8_t getRoleCode(uint32_t v) const
+    {
+        return chunkOf(v).roleCodes[v % SNAPSHOT_SEGMENT_SIZE];
+    }
 
-            distance[source] = 0;
-            numShortestPaths[source] = 1;
+    bool find(const string& name, uint32_t& v) const
+    {
+        const auto& shard = *idShards[shardOf(name)];
+        auto it = shard.find(name);
+        if (it == shard.end())
+        {
+            return false;
+        }
+        v = it->second;
+        return true;
+    }
+};
 
-            queue<string> bfsQueue;
-            bfsQueue.push(source);
+// Immutable version of the graph. Segments and the vertex table are shared with
+// older and newer versions whenever they were not touched in between.
+class GraphSnapshot {
 
-            while (!bfsQueue.empty()) {
-                string current = bfsQueue.front();
-                bfsQueue.pop();
+private:
+    uint64_t version;
+    shared_ptr<const VertexTable> vertices;
+    vector<shared_ptr<const CsrSegment>> segments;
+    size_t edgeCount;
 
-                for (const auto& edge : edges) {
-                    if (edge->getSource()->getName() == current)
-                    {
-                        string neighbor = edge->getDestination()->getName();
-                        if (distance.find(neighbor) == distance.end())
-                        {
-                            distance[neighbor] = distance[current] + 1;
-                            bfsQueue.push(neighbor);
-                        }
+public:
+    GraphSnapshot(uint64_t v, shared_ptr<const VertexTable> table, vector<shared_ptr<const CsrSegment>> s, size_t e)
+        : version(v), vertices(move(table)), segments(move(s)), edgeCount(e) {}
 
-                        if (distance[neighbor] == distance[current] + 1)
-                        {
-                            numShortestPaths[neighbor] += numShortestPaths[current];
-                            predecessors[neighbor].push_back(current);
-                        }
+    uint64_t getVersion() const
+    {
+        return version;
+    }
 
-                    }
+    uint32_t getVertexCount() const
+    {
+        return vertices->vertexCount;
+    }
 
-                }
+    size_t getEdgeCount() const
+    {
+        return edgeCount;
+    }
+
+    bool isPresent(uint32_t v) const
+    {
+        return vertices->isPresent(v);
+    }
 
+    const string& getName(uint32_t v) const
+    {
+        return vertices->getName(v);
+    }
 
+    const string& getRole(uint32_t v) const
+    {
+        static const string none;
+        if (v >= vertices->vertexCount || !vertices->isPresent(v) || vertices->getRoleCode(v) == NO_ROLE)
+        {
+            return none;
+        }
+        return vertices->roleNames[vertices->getRoleCode(v)];
+    }
 
-            }
+    bool findVertex(const string& name, uint32_t& v) const
+    {
+        return vertices->find(name, v);
+    }
 
+    const shared_ptr<const VertexTable>& getVertexTable() const
+    {
+        return vertices;
+    }
 
-            unordered_map<string, double> dependency;
-            for (const auto& node : nodes) {
-                dependency[node.first] = 0.0;
-            }
+    const vector<shared_ptr<const CsrSegment>>& getSegments() const
+    {
+        return segments;
+    }
 
-            while (!bfsQueue.empty()) {
-                string current = bfsQueue.front();
-                bfsQueue.pop();
+    AdjacencyRange outEdges(uint32_t v) const
+    {
+        const CsrSegment& segment = *segments[v / SNAPSHOT_SEGMENT_SIZE];
+        uint32_t local = v % SNAPSHOT_SEGMENT_SIZE;
+        uint32_t first = segment.outOffsets[local];
+        return { segment.outTargets.data() + first, segment.outWeights.data() + first,
+            segment.outTypes.data() + first, segment.outOffsets[local + 1] - first };
+    }
 
-                for (const auto& predecessor : predecessors[current])
-                {
+    template <typename Visitor>
+    void forEachOutNeighbor(uint32_t v, Visitor&& visit) const
+    {
+        for (uint32_t neighbor : outEdges(v))
+        {
+            visit(neighbor);
+        }
+    }
 
-                    dependency[predecessor] += (numShortestPaths[predecessor] / numShortestPaths[current]) *
-                        (1 + dependency[current]);
+    AdjacencyRange inEdges(uint32_t v) const
+    {
+        const CsrSegment& segment = *segments[v / SNAPSHOT_SEGMENT_SIZE];
+        uint32_t local = v % SNAPSHOT_SEGMENT_SIZE;
+        uint32_t first = segment.inOffsets[local];
+        return { segment.inSources.data() + first, segment.inWeights.data() + first,
+            segment.inTypes.data() + first, segment.inOffsets[local + 1] - first };
+    }
+};
 
-                }
+// Shuffle masks and byte lengths for Stream-VByte groups, indexed by control byte.
+struct StreamVByteTables {
+    uint8_t shuffle[256][16];
+    uint8_t length[256];
 
-                if (current != source)
+    StreamVByteTables()
+    {
+        for (int control = 0; control < 256; ++control)
+        {
+            uint8_t byte = 0;
+            for (int value = 0; value < 4; ++value)
+            {
+                int size = ((control >> (2 * value)) & 3) + 1;
+                for (int i = 0; i < 4; ++i)
                 {
-                    betweennessCentrality[current] += dependency[current];
+                    shuffle[control][4 * value + i] = i < size ? byte++ : 0xFF;
                 }
             }
+            length[control] = byte;
         }
+    }
+};
 
-        double maxBetweenness = 0.0;
-        vector<string> influentialNodes;
+static const StreamVByteTables streamVByteTables;
 
-        for (const auto& node : betweennessCentrality)
+// Linear one-byte quantization of relationship weights between the lightest and
+// the heaviest relationship of a snapshot.
+struct WeightQuantizer {
+    double minWeight = 0.0;
+    double step = 0.0;
+
+    static WeightQuantizer over(const GraphSnapshot& graph)
+    {
+        WeightQuantizer quantizer;
+        double maxWeight = 0.0;
+        bool anyEdge = false;
+        for (uint32_t v = 0; v < graph.getVertexCount(); ++v)
         {
-            if (node.second > maxBetweenness)
+            AdjacencyRange adjacency = graph.outEdges(v);
+            for (uint32_t i = 0; i < adjacency.size(); ++i)
             {
-
-
-                maxBetweenness = node.second;
-                influentialNodes.clear();
-                influentialNodes.push_back(node.first);
-
-
+                quantizer.minWeight = anyEdge ? min(quantizer.minWeight, adjacency.weights[i]) : adjacency.weights[i];
+                maxWeight = anyEdge ? max(maxWeight, adjacency.weights[i]) : adjacency.weights[i];
+                anyEdge = true;
             }
+        }
+        quantizer.step = (maxWeight - quantizer.minWeight) / 255.0;
+        return quantizer;
+    }
 
-            else if (node.second == maxBetweenness)
-            {
+    uint8_t encode(double weight) const
+    {
+        return static_cast<uint8_t>(lround(step > 0 ? (weight - minWeight) / step : 0.0));
+    }
 
-                influentialNodes.push_back(node.first);
+    double decode(uint8_t code) const
+    {
+        return minWeight + step * code;
+    }
+};
 
-            }
+// Read-only out-adjacency for very large graphs. For every vertex the sorted
+// neighbor ids are gap-encoded, the relationship type is packed into the low three
+// bits of each gap, and the values are stored Stream-VByte style: one control byte
+// per four values (two bits of byte length each) followed by the value bytes.
+// Weights are quantized to one byte by a WeightQuantizer.
+//
+// All vertices share one byte stream and keep a single offset into it. A vertex's
+// record is its degree as a varint, its control bytes, its weight bytes and then
+// its value bytes, so the other three positions follow from the degree. The
+// stream is sized exactly before it is filled and is never reallocated.
+// Decoding uses a PSHUFB table only when built with SSSE3 (e.g. -mssse3); the
+// default build decodes each group with the scalar loop.
+class CompressedGraph {
 
+private:
+    shared_ptr<const VertexTable> vertices;
+    vector<uint64_t> offsets;
+    vector<uint8_t> bytes;
+    uint64_t edgeCount = 0;
+    WeightQuantizer quantizer;
 
-        }
+    static uint32_t valueSize(uint32_t value)
+    {
+        return value < (1u << 8) ? 1 : value < (1u << 16) ? 2 : value < (1u << 24) ? 3 : 4;
+    }
 
+    static uint32_t varintSize(uint32_t value)
+    {
+        uint32_t size = 1;
+        for (; value >= 0x80; value >>= 7)
+        {
+            ++size;
+        }
+        return size;
+    }
 
+    static uint32_t gapValue(const AdjacencyRange& adjacency, uint32_t i)
+    {
+        uint32_t previous = i == 0 ? 0 : adjacency.vertices[i - 1];
+        return ((adjacency.vertices[i] - previous) << 3) | (adjacency.types[i] & 7);
+    }
 
-        cout << "\nMost influential individuals by betweenness centrality:\n";
-        for (const auto& nodeName : influentialNodes)
+    // Reads the degree of the record at cursor and leaves cursor on its control bytes.
+    static uint32_t readDegree(const uint8_t*& cursor)
+    {
+        uint32_t degree = 0;
+        for (int shift = 0;; shift += 7)
         {
-
-            cout << nodeName << " (Betweenness Centrality: " << betweennessCentrality[nodeName] << ")\n";
+            uint8_t byte = *cursor++;
+            degree |= static_cast<uint32_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return degree;
+            }
         }
     }
-    void identifySocialClusters()
-    {
-        unordered_map<string, int> communitySize;
 
-        for (const auto& edge : edges)
+    static void decodeGroup(const uint8_t control, const uint8_t* data, uint32_t* values)
+    {
+#ifdef STREAMVBYTE_SIMD
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(streamVByteTables.shuffle[control]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values), _mm_shuffle_epi8(bytes, mask));
+#else
+        for (int value = 0; value < 4; ++value)
         {
-            communitySize[edge->getSource()->getName()]++;
-            communitySize[edge->getDestination()->getName()]++;
+            int size = ((control >> (2 * value)) & 3) + 1;
+            uint32_t decoded = 0;
+            for (int i = 0; i < size; ++i)
+            {
+                decoded |= static_cast<uint32_t>(data[i]) << (8 * i);
+            }
+            values[value] = decoded;
+            data += size;
         }
+#endif
+    }
 
+public:
+    static constexpr uint32_t MAX_VERTICES = 1u << 29;
 
-        int maxEdges = 0;
-        vector<string> socialClusters;
+    // Gaps keep three bits for the relationship type, so vertex ids must stay below MAX_VERTICES.
+    static bool fits(const GraphSnapshot& graph)
+    {
+        return graph.getVertexCount() < MAX_VERTICES;
+    }
 
+    // Requires fits(graph).
+    explicit CompressedGraph(const GraphSnapshot& graph)
+        : vertices(graph.getVertexTable())
+    {
+        uint32_t vertexCount = graph.getVertexCount();
+        offsets.assign(vertexCount + 1, 0);
+        quantizer = WeightQuantizer::over(graph);
 
-        for (const auto& node : communitySize)
+        // First pass: the exact size of every record.
+        for (uint32_t v = 0; v < vertexCount; ++v)
         {
-            if (node.second > maxEdges)
+            AdjacencyRange adjacency = graph.outEdges(v);
+            uint64_t size = varintSize(adjacency.size()) + (adjacency.size() + 3) / 4 + adjacency.size();
+            for (uint32_t i = 0; i < adjacency.size(); ++i)
             {
-                maxEdges = node.second;
-                socialClusters.clear();
-                socialClusters.push_back(node.first);
+                size += valueSize(gapValue(adjacency, i));
             }
+            offsets[v + 1] = offsets[v] + size;
+            edgeCount += adjacency.size();
+        }
 
-            else if (node.second == maxEdges)
+        // The padding lets decodeGroup load 16 bytes past the last value.
+        bytes.assign(offsets[vertexCount] + 16, 0);
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            AdjacencyRange adjacency = graph.outEdges(v);
+            uint32_t degree = adjacency.size();
+            uint8_t* cursor = bytes.data() + offsets[v];
+            for (uint32_t value = degree; ; value >>= 7)
             {
-                socialClusters.push_back(node.first);
+                *cursor++ = static_cast<uint8_t>((value & 0x7f) | (value >= 0x80 ? 0x80 : 0));
+                if (value < 0x80)
+                {
+                    break;
+                }
+            }
+            uint8_t* control = cursor;
+            uint8_t* weight = control + (degree + 3) / 4;
+            uint8_t* data = weight + degree;
+            for (uint32_t i = 0; i < degree; ++i)
+            {
+                uint32_t value = gapValue(adjacency, i);
+                uint32_t size = valueSize(value);
+                control[i / 4] |= static_cast<uint8_t>((size - 1) << (2 * (i % 4)));
+                for (uint32_t b = 0; b < size; ++b)
+                {
+                    *data++ = static_cast<uint8_t>(value >> (8 * b));
+                }
+                weight[i] = quantizer.encode(adjacency.weights[i]);
             }
-
         }
+    }
 
-        cout << "Social Clusters (Nodes with Maximum Edges):\n";
-        for (const auto& nodeName : socialClusters)
-        {
-            cout << nodeName << " (Edges: " << communitySize[nodeName] << ")\n";
-        }
+    uint32_t getVertexCount() const
+    {
+        return static_cast<uint32_t>(offsets.size() - 1);
     }
 
-    void addEvent(const string& name, const string& date)
+    uint64_t getEdgeCount() const
     {
-        events.push_back(new Event(name, date));
-        attendance[name] = vector<string>();
+        return edgeCount;
     }
 
-    void removeEvent(const string& name)
+    bool isPresent(uint32_t v) const
     {
-        auto it = find_if(events.begin(), events.end(), [&name](const Event* event)
-            {
+        return vertices->isPresent(v);
+    }
+
+    const string& getName(uint32_t v) const
+    {
+        return vertices->getName(v);
+    }
+
+    uint32_t getOutDegree(uint32_t v) const
+    {
+        const uint8_t* cursor = bytes.data() + offsets[v];
+        return readDegree(cursor);
+    }
+
+    // Calls visit(neighbor, weight, relationshipType) for every out-edge of v in neighbor order.
+    template <typename Visitor>
+    void forEachOutEdge(uint32_t v, Visitor&& visit) const
+    {
+        const uint8_t* control = bytes.data() + offsets[v];
+        uint32_t remaining = readDegree(control);
+        const uint8_t* weight = control + (remaining + 3) / 4;
+        const uint8_t* data = weight + remaining;
+        uint32_t previous = 0;
+        uint32_t values[4];
+
+        while (remaining > 0)
+        {
+            decodeGroup(*control, data, values);
+            data += streamVByteTables.length[*control];
+            ++control;
+
+            uint32_t count = min<uint32_t>(4, remaining);
+            for (uint32_t j = 0; j < count; ++j)
+            {
+                previous += values[j] >> 3;
+                visit(previous, quantizer.decode(*weight++), static_cast<RelationshipType>(values[j] & 7));
+            }
+            remaining -= count;
+        }
+    }
+
+    template <typename Visitor>
+    void forEachOutNeighbor(uint32_t v, Visitor&& visit) const
+    {
+        forEachOutEdge(v, [&visit](uint32_t neighbor, double, RelationshipType) { visit(neighbor); });
+    }
+
+    size_t getMemoryBytes() const
+    {
+        return offsets.capacity() * sizeof(uint64_t) + bytes.capacity();
+    }
+};
+
+// Weight policies for TypedGraph. Unweighted graphs keep no weight column at all;
+// uint8_t weights are quantized by a WeightQuantizer.
+struct Unweighted {};
+
+template <typename Weight>
+struct WeightPolicy;
+
+template <>
+struct WeightPolicy<Unweighted> {
+    static constexpr bool stored = false;
+    using Storage = uint8_t;
+    static const char* name() { return "unweighted"; }
+};
+
+template <>
+struct WeightPolicy<uint8_t> {
+    static constexpr bool stored = true;
+    using Storage = uint8_t;
+    static const char* name() { return "uint8"; }
+};
+
+template <>
+struct WeightPolicy<float> {
+    static constexpr bool stored = true;
+    using Storage = float;
+    static const char* name() { return "float"; }
+};
+
+template <>
+struct WeightPolicy<double> {
+    static constexpr bool stored = true;
+    using Storage = double;
+    static const char* name() { return "double"; }
+};
+
+// Direction policies. An undirected graph lists every relationship under both endpoints.
+struct Directed {
+    static constexpr bool symmetric = false;
+    static const char* name() { return "directed"; }
+};
+
+struct Undirected {
+    static constexpr bool symmetric = true;
+    static const char* name() { return "undirected"; }
+};
+
+// Flat CSR view of a snapshot specialized for one weight type and direction, so
+// an algorithm only pays for the weight column and the edge directions it uses.
+template <typename Weight, typename Direction>
+class TypedGraph {
+
+public:
+    using Storage = typename WeightPolicy<Weight>::Storage;
+    static constexpr bool weighted = WeightPolicy<Weight>::stored;
+    static constexpr bool symmetric = Direction::symmetric;
+
+private:
+    shared_ptr<const VertexTable> vertices;
+    vector<uint32_t> offsets;
+    vector<uint32_t> targets;
+    vector<Storage> weights;
+    WeightQuantizer quantizer;
+
+    Storage encode(double weight) const
+    {
+        if constexpr (is_same<Weight, uint8_t>::value)
+        {
+            return quantizer.encode(weight);
+        }
+        else
+        {
+            return static_cast<Storage>(weight);
+        }
+    }
+
+public:
+    explicit TypedGraph(const GraphSnapshot& graph)
+        : vertices(graph.getVertexTable())
+    {
+        uint32_t vertexCount = graph.getVertexCount();
+        offsets.assign(vertexCount + 1, 0);
+        targets.reserve(symmetric ? 2 * graph.getEdgeCount() : graph.getEdgeCount());
+
+        if constexpr (is_same<Weight, uint8_t>::value)
+        {
+            quantizer = WeightQuantizer::over(graph);
+        }
+
+        vector<pair<uint32_t, double>> adjacent;
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            AdjacencyRange out = graph.outEdges(v);
+            adjacent.clear();
+            for (uint32_t i = 0; i < out.size(); ++i)
+            {
+                adjacent.emplace_back(out.vertices[i], out.weights[i]);
+            }
+            if constexpr (symmetric)
+            {
+                AdjacencyRange in = graph.inEdges(v);
+                for (uint32_t i = 0; i < in.size(); ++i)
+                {
+                    adjacent.emplace_back(in.vertices[i], in.weights[i]);
+                }
+                sort(adjacent.begin(), adjacent.end());
+            }
+
+            for (const auto& edge : adjacent)
+            {
+                targets.push_back(edge.first);
+                if constexpr (weighted)
+                {
+                    weights.push_back(encode(edge.second));
+                }
+            }
+            offsets[v + 1] = static_cast<uint32_t>(targets.size());
+        }
+    }
+
+    uint32_t getVertexCount() const
+    {
+        return static_cast<uint32_t>(offsets.size() - 1);
+    }
+
+    size_t getEdgeCount() const
+    {
+        return targets.size();
+    }
+
+    bool isPresent(uint32_t v) const
+    {
+        return vertices->isPresent(v);
+    }
+
+    const string& getName(uint32_t v) const
+    {
+        return vertices->getName(v);
+    }
+
+    uint32_t getDegree(uint32_t v) const
+    {
+        return offsets[v + 1] - offsets[v];
+    }
+
+    // Calls visit(neighbor, weight) for every edge of v; unweighted graphs report a weight of 1.
+    template <typename Visitor>
+    void forEachOutEdge(uint32_t v, Visitor&& visit) const
+    {
+        for (uint32_t i = offsets[v]; i < offsets[v + 1]; ++i)
+        {
+            if constexpr (is_same<Weight, uint8_t>::value)
+            {
+                visit(targets[i], quantizer.decode(weights[i]));
+            }
+            else if constexpr (weighted)
+            {
+                visit(targets[i], static_cast<double>(weights[i]));
+            }
+            else
+            {
+                visit(targets[i], 1.0);
+            }
+        }
+    }
+
+    template <typename Visitor>
+    void forEachOutNeighbor(uint32_t v, Visitor&& visit) const
+    {
+        for (uint32_t i = offsets[v]; i < offsets[v + 1]; ++i)
+        {
+            visit(targets[i]);
+        }
+    }
+
+    size_t getMemoryBytes() const
+    {
+        return (offsets.capacity() + targets.capacity()) * sizeof(uint32_t) + weights.capacity() * sizeof(Storage);
+    }
+};
+
+// Relationship reach ignores weights and follows edges from source to destination.
+using ReachGraph = TypedGraph<Unweighted, Directed>;
+
+// Read-only memory mapping of a whole file; pages are faulted in on access and
+// released by the kernel under memory pressure or when the mapping is closed.
+class MappedFile {
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+public:
+    explicit MappedFile(const string& path)
+    {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        LARGE_INTEGER fileSize;
+        if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+        {
+            return;
+        }
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr)
+        {
+            data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            size = data != nullptr ? static_cast<size_t>(fileSize.QuadPart) : 0;
+        }
+#else
+        int descriptor = open(path.c_str(), O_RDONLY);
+        struct stat status;
+        if (descriptor < 0)
+        {
+            return;
+        }
+        if (fstat(descriptor, &status) == 0 && status.st_size > 0)
+        {
+            void* mapped = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (mapped != MAP_FAILED)
+            {
+                data = static_cast<const uint8_t*>(mapped);
+                size = static_cast<size_t>(status.st_size);
+                madvise(mapped, size, MADV_SEQUENTIAL);
+            }
+        }
+        close(descriptor);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+#ifdef _WIN32
+        if (data != nullptr)
+        {
+            UnmapViewOfFile(data);
+        }
+        if (mapping != nullptr)
+        {
+            CloseHandle(mapping);
+        }
+        if (file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(file);
+        }
+#else
+        if (data != nullptr)
+        {
+            munmap(const_cast<uint8_t*>(data), size);
+        }
+#endif
+    }
+
+    bool isOpen() const
+    {
+        return data != nullptr;
+    }
+
+    const uint8_t* getData() const
+    {
+        return data;
+    }
+
+    size_t getSize() const
+    {
+        return size;
+    }
+};
+
+// External-memory adjacency split into vertex-range partitions on disk. Each file
+// "<dir>/partition.<p>" holds a header, u64 offsets and u32 targets for the out-edges
+// of its vertex range. Scans map one partition at a time, so resident memory stays
+// at O(vertices) plus a single partition regardless of the number of edges.
+class PartitionedGraph {
+
+private:
+    static constexpr uint64_t PARTITION_MAGIC = 0x31305452415053ULL;
+
+    struct PartitionHeader {
+        uint64_t magic;
+        uint64_t firstVertex;
+        uint64_t vertexCount;
+        uint64_t edgeCount;
+    };
+
+    string directory;
+    uint32_t vertexCount = 0;
+    uint32_t partitionCount = 0;
+    uint32_t verticesPerPartition = 1;
+    vector<string> names;
+    vector<uint32_t> outDegrees;
+
+    string partitionPath(uint32_t partition) const
+    {
+        return directory + "/partition." + to_string(partition);
+    }
+
+    uint32_t firstVertex(uint32_t partition) const
+    {
+        return static_cast<uint32_t>(min<uint64_t>(vertexCount, static_cast<uint64_t>(partition) * verticesPerPartition));
+    }
+
+    // Checks that a mapped partition file has the header of partition p and is
+    // exactly as long as its header says. With checkContents, also checks that the
+    // offsets are monotonic and end at the edge count and that every target is a
+    // vertex, so a scan of a checked file never reads outside it.
+    bool isValidPartition(const MappedFile& file, uint32_t partition, bool checkContents) const
+    {
+        if (!file.isOpen() || file.getSize() < sizeof(PartitionHeader))
+        {
+            return false;
+        }
+        PartitionHeader header;
+        memcpy(&header, file.getData(), sizeof(header));
+        uint64_t first = firstVertex(partition);
+        uint64_t expectedVertices = min<uint64_t>(vertexCount, first + verticesPerPartition) - first;
+        if (header.magic != PARTITION_MAGIC || header.firstVertex != first || header.vertexCount != expectedVertices
+            || header.edgeCount > file.getSize() / sizeof(uint32_t)
+            || sizeof(header) + (header.vertexCount + 1) * sizeof(uint64_t) + header.edgeCount * sizeof(uint32_t) != file.getSize())
+        {
+            return false;
+        }
+        if (!checkContents)
+        {
+            return true;
+        }
+
+        const uint64_t* offsets = reinterpret_cast<const uint64_t*>(file.getData() + sizeof(header));
+        const uint32_t* targets = reinterpret_cast<const uint32_t*>(offsets + header.vertexCount + 1);
+        if (offsets[0] != 0 || offsets[header.vertexCount] != header.edgeCount)
+        {
+            return false;
+        }
+        for (uint64_t local = 0; local < header.vertexCount; ++local)
+        {
+            if (offsets[local] > offsets[local + 1])
+            {
+                return false;
+            }
+        }
+        for (uint64_t i = 0; i < header.edgeCount; ++i)
+        {
+            if (targets[i] >= vertexCount)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Maps partition p and calls visit(vertex, targets, count) for every vertex
+    // selected by wanted(vertex) in its range. The contents were checked by open().
+    template <typename Filter, typename Visitor>
+    bool scanPartition(uint32_t partition, Filter&& wanted, Visitor&& visit) const
+    {
+        MappedFile file(partitionPath(partition));
+        if (!isValidPartition(file, partition, false))
+        {
+            return false;
+        }
+
+        PartitionHeader header;
+        memcpy(&header, file.getData(), sizeof(header));
+        const uint64_t* offsets = reinterpret_cast<const uint64_t*>(file.getData() + sizeof(header));
+        const uint32_t* targets = reinterpret_cast<const uint32_t*>(offsets + header.vertexCount + 1);
+        for (uint64_t local = 0; local < header.vertexCount; ++local)
+        {
+            uint32_t vertex = static_cast<uint32_t>(header.firstVertex + local);
+            if (wanted(vertex))
+            {
+                visit(vertex, targets + offsets[local], static_cast<uint32_t>(offsets[local + 1] - offsets[local]));
+            }
+        }
+        return true;
+    }
+
+public:
+    // Streams edges into per-partition bucket files, then sorts each bucket on its
+    // own to write the partition, so at most one partition is held in memory.
+    // Edges are buffered and appended to the buckets in batches with one file open
+    // at a time, so the partition count is not limited by open file handles.
+    class Builder {
+
+    private:
+        static constexpr size_t BUFFERED_EDGES = 1 << 20;
+
+        string directory;
+        uint32_t vertexCount;
+        uint32_t partitionCount;
+        uint32_t verticesPerPartition;
+        vector<vector<uint32_t>> buffers;
+        size_t bufferedEdges = 0;
+        vector<uint64_t> bucketEdges;
+        bool writeFailed = false;
+
+        string bucketPath(uint32_t partition) const
+        {
+            return directory + "/bucket." + to_string(partition);
+        }
+
+        void flushBuffers()
+        {
+            for (uint32_t p = 0; p < partitionCount; ++p)
+            {
+                if (buffers[p].empty())
+                {
+                    continue;
+                }
+                ofstream bucket(bucketPath(p), ios::binary | ios::app);
+                bucket.write(reinterpret_cast<const char*>(buffers[p].data()), buffers[p].size() * sizeof(uint32_t));
+                writeFailed = writeFailed || !bucket.good();
+                buffers[p].clear();
+            }
+            bufferedEdges = 0;
+        }
+
+    public:
+        Builder(const string& dir, const vector<string>& vertexNames, uint32_t partitions)
+            : directory(dir), vertexCount(static_cast<uint32_t>(vertexNames.size())),
+            partitionCount(max<uint32_t>(1, partitions)),
+            verticesPerPartition(max<uint32_t>(1, (vertexCount + max<uint32_t>(1, partitions) - 1) / max<uint32_t>(1, partitions))),
+            bucketEdges(partitionCount, 0)
+        {
+            error_code ec;
+            filesystem::create_directories(directory, ec);
+            ofstream metaFile(directory + "/meta");
+            metaFile << vertexCount << " " << partitionCount << " " << verticesPerPartition << "\n";
+            ofstream namesFile(directory + "/vertices");
+            for (const auto& name : vertexNames)
+            {
+                namesFile << name << "\n";
+            }
+            buffers.resize(partitionCount);
+            for (uint32_t p = 0; p < partitionCount; ++p)
+            {
+                filesystem::remove(bucketPath(p), ec);
+            }
+        }
+
+        void addEdge(uint32_t source, uint32_t destination)
+        {
+            uint32_t partition = source / verticesPerPartition;
+            buffers[partition].push_back(source);
+            buffers[partition].push_back(destination);
+            ++bucketEdges[partition];
+            if (++bufferedEdges >= BUFFERED_EDGES)
+            {
+                flushBuffers();
+            }
+        }
+
+        bool finish()
+        {
+            flushBuffers();
+            bool ok = !writeFailed;
+            for (uint32_t p = 0; p < partitionCount; ++p)
+            {
+                vector<uint32_t> pairs(2 * bucketEdges[p]);
+                if (bucketEdges[p] > 0)
+                {
+                    ifstream bucket(bucketPath(p), ios::binary);
+                    ok = ok && bucket.read(reinterpret_cast<char*>(pairs.data()), pairs.size() * sizeof(uint32_t));
+                }
+
+                PartitionHeader header;
+                header.magic = PARTITION_MAGIC;
+                header.firstVertex = min<uint64_t>(vertexCount, static_cast<uint64_t>(p) * verticesPerPartition);
+                header.vertexCount = min<uint64_t>(vertexCount, header.firstVertex + verticesPerPartition) - header.firstVertex;
+                header.edgeCount = bucketEdges[p];
+
+                vector<uint64_t> offsets(header.vertexCount + 1, 0);
+                for (uint64_t i = 0; i < bucketEdges[p]; ++i)
+                {
+                    ++offsets[pairs[2 * i] - header.firstVertex + 1];
+                }
+                for (uint64_t v = 0; v < header.vertexCount; ++v)
+                {
+                    offsets[v + 1] += offsets[v];
+                }
+                vector<uint64_t> cursor(offsets.begin(), offsets.end() - 1);
+                vector<uint32_t> targets(bucketEdges[p]);
+                for (uint64_t i = 0; i < bucketEdges[p]; ++i)
+                {
+                    targets[cursor[pairs[2 * i] - header.firstVertex]++] = pairs[2 * i + 1];
+                }
+                for (uint64_t v = 0; v < header.vertexCount; ++v)
+                {
+                    sort(targets.begin() + offsets[v], targets.begin() + offsets[v + 1]);
+                }
+
+                ofstream partitionFile(directory + "/partition." + to_string(p), ios::binary | ios::trunc);
+                partitionFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                partitionFile.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+                partitionFile.write(reinterpret_cast<const char*>(targets.data()), targets.size() * sizeof(uint32_t));
+                ok = ok && partitionFile.good();
+
+                error_code ec;
+                filesystem::remove(bucketPath(p), ec);
+            }
+            return ok;
+        }
+    };
+
+    // Builds partitions straight from a file written by storeGraphDetailsToFile,
+    // reading it line by line so the edge list never has to fit in memory.
+    static bool buildFromGraphFile(const string& graphFile, const string& dir, uint32_t partitions)
+    {
+        ifstream inFile(graphFile);
+        if (!inFile.is_open())
+        {
+            cerr << "Unable to open file: " << graphFile << endl;
+            return false;
+        }
+
+        vector<string> vertexNames;
+        unordered_map<string, uint32_t> ids;
+        unique_ptr<Builder> builder;
+        string line;
+        string section;
+
+        while (getline(inFile, line))
+        {
+            if (line.empty())
+            {
+                continue;
+            }
+            if (line == "Nodes:" || line == "Edges:" || line == "Events:" || line == "Attendance:")
+            {
+                section = line;
+                if (section == "Edges:")
+                {
+                    builder = make_unique<Builder>(dir, vertexNames, partitions);
+                }
+                continue;
+            }
+
+            vector<string> fields = splitFields(line, ',');
+            if (section == "Nodes:")
+            {
+                string name = unescapeField(fields[0]);
+                if (ids.insert({ name, static_cast<uint32_t>(vertexNames.size()) }).second)
+                {
+                    vertexNames.push_back(name);
+                }
+            }
+            else if (section == "Edges:" && fields.size() >= 2)
+            {
+                auto source = ids.find(unescapeField(fields[0]));
+                auto destination = ids.find(unescapeField(fields[1]));
+                if (source != ids.end() && destination != ids.end())
+                {
+                    builder->addEdge(source->second, destination->second);
+                }
+            }
+        }
+
+        if (!builder)
+        {
+            builder = make_unique<Builder>(dir, vertexNames, partitions);
+        }
+        return builder->finish();
+    }
+
+    static bool buildFromSnapshot(const GraphSnapshot& graph, const string& dir, uint32_t partitions)
+    {
+        vector<string> vertexNames(graph.getVertexCount());
+        for (uint32_t v = 0; v < graph.getVertexCount(); ++v)
+        {
+            vertexNames[v] = graph.isPresent(v) ? graph.getName(v) : "";
+        }
+
+        Builder builder(dir, vertexNames, partitions);
+        for (uint32_t v = 0; v < graph.getVertexCount(); ++v)
+        {
+            for (uint32_t neighbor : graph.outEdges(v))
+            {
+                builder.addEdge(v, neighbor);
+            }
+        }
+        return builder.finish();
+    }
+
+    bool open(const string& dir)
+    {
+        directory = dir;
+        ifstream metaFile(directory + "/meta");
+        if (!(metaFile >> vertexCount >> partitionCount >> verticesPerPartition))
+        {
+            cerr << "Error: " << directory << " does not contain a partitioned graph.\n";
+            return false;
+        }
+
+        names.assign(vertexCount, "");
+        ifstream namesFile(directory + "/vertices");
+        for (uint32_t v = 0; v < vertexCount && getline(namesFile, names[v]); ++v)
+        {
+        }
+
+        if (partitionCount == 0 || verticesPerPartition == 0
+            || static_cast<uint64_t>(partitionCount) * verticesPerPartition < vertexCount)
+        {
+            cerr << "Error: " << directory << "/meta is corrupt.\n";
+            return false;
+        }
+        for (uint32_t p = 0; p < partitionCount; ++p)
+        {
+            if (!isValidPartition(MappedFile(partitionPath(p)), p, true))
+            {
+                cerr << "Error: " << partitionPath(p) << " is missing, truncated or corrupt.\n";
+                vertexCount = 0;
+                partitionCount = 0;
+                return false;
+            }
+        }
+
+        outDegrees.assign(vertexCount, 0);
+        for (uint32_t p = 0; p < partitionCount; ++p)
+        {
+            scanPartition(p, [](uint32_t) { return true; },
+                [this](uint32_t vertex, const uint32_t*, uint32_t count) { outDegrees[vertex] = count; });
+        }
+        return true;
+    }
+
+    uint32_t getVertexCount() const
+    {
+        return vertexCount;
+    }
+
+    const string& getName(uint32_t v) const
+    {
+        return names[v];
+    }
+
+    bool findVertex(const string& name, uint32_t& v) const
+    {
+        auto it = find(names.begin(), names.end(), name);
+        if (name.empty() || it == names.end())
+        {
+            return false;
+        }
+        v = static_cast<uint32_t>(it - names.begin());
+        return true;
+    }
+
+    // Level-synchronous BFS. Each level streams only the partitions that contain
+    // at least one frontier vertex.
+    vector<int32_t> breadthFirstSearch(uint32_t source) const
+    {
+        vector<int32_t> distance(vertexCount, -1);
+        vector<uint8_t> inFrontier(vertexCount, 0);
+        vector<uint32_t> frontierPerPartition(partitionCount, 0);
+        distance[source] = 0;
+        inFrontier[source] = 1;
+        frontierPerPartition[source / verticesPerPartition] = 1;
+        int32_t level = 0;
+        bool active = true;
+
+        while (active)
+        {
+            vector<uint8_t> nextFrontier(vertexCount, 0);
+            vector<uint32_t> nextPerPartition(partitionCount, 0);
+            active = false;
+
+            for (uint32_t p = 0; p < partitionCount; ++p)
+            {
+                if (frontierPerPartition[p] == 0)
+                {
+                    continue;
+                }
+                scanPartition(p, [&inFrontier](uint32_t vertex) { return inFrontier[vertex] != 0; },
+                    [&](uint32_t, const uint32_t* targets, uint32_t count)
+                    {
+                        for (uint32_t i = 0; i < count; ++i)
+                        {
+                            uint32_t neighbor = targets[i];
+                            if (distance[neighbor] < 0)
+                            {
+                                distance[neighbor] = level + 1;
+                                nextFrontier[neighbor] = 1;
+                                ++nextPerPartition[neighbor / verticesPerPartition];
+                                active = true;
+                            }
+                        }
+                    });
+            }
+
+            inFrontier.swap(nextFrontier);
+            frontierPerPartition.swap(nextPerPartition);
+            ++level;
+        }
+        return distance;
+    }
+
+    // Power iteration; every iteration streams all partitions once in order.
+    vector<double> pageRank(int iterations, double damping = 0.85) const
+    {
+        uint32_t presentCount = static_cast<uint32_t>(count_if(names.begin(), names.end(),
+            [](const string& name) { return !name.empty(); }));
+        vector<double> rank(vertexCount, 0.0);
+        vector<double> next(vertexCount, 0.0);
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            rank[v] = names[v].empty() ? 0.0 : 1.0 / presentCount;
+        }
+
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            double danglingMass = 0.0;
+            for (uint32_t v = 0; v < vertexCount; ++v)
+            {
+                if (outDegrees[v] == 0)
+                {
+                    danglingMass += rank[v];
+                }
+            }
+            double base = (1.0 - damping + damping * danglingMass) / max<uint32_t>(1, presentCount);
+            for (uint32_t v = 0; v < vertexCount; ++v)
+            {
+                next[v] = names[v].empty() ? 0.0 : base;
+            }
+
+            for (uint32_t p = 0; p < partitionCount; ++p)
+            {
+                scanPartition(p, [](uint32_t) { return true; },
+                    [&](uint32_t vertex, const uint32_t* targets, uint32_t count)
+                    {
+                        double share = damping * rank[vertex] / max<uint32_t>(1, count);
+                        for (uint32_t i = 0; i < count; ++i)
+                        {
+                            next[targets[i]] += share;
+                        }
+                    });
+            }
+            rank.swap(next);
+        }
+        return rank;
+    }
+};
+
+enum PartitioningScheme {
+    PARTITION_1D,
+    PARTITION_2D
+};
+
+// Runs BFS and PageRank across local worker processes in bulk-synchronous
+// supersteps. Each worker owns a block of edges: in 1D mode every edge whose
+// source lies in its vertex range, in 2D mode the edges of one (source range,
+// destination range) cell of an R x C grid. The coordinator sends each worker the
+// part of the frontier or rank vector it needs over a local socket pair and merges
+// the replies before starting the next superstep.
+//
+// Workers are fresh copies of this program started with posix_spawn in worker
+// mode, not forks: the coordinator already runs scheduler and background threads,
+// and a forked child could inherit a malloc or stream lock held by one of them.
+// A new worker receives its vertex ranges and edge block as its first messages.
+class PartitionedWorkerPool {
+
+public:
+    static constexpr const char* WORKER_ARGUMENT = "--partition-worker";
+    static constexpr int WORKER_SOCKET = 3;
+
+private:
+    enum MessageType : uint32_t {
+        MESSAGE_PARTITION = 1,
+        MESSAGE_BFS_RESET,
+        MESSAGE_BFS_STEP,
+        MESSAGE_PAGERANK_STEP,
+        MESSAGE_SHUTDOWN
+    };
+
+    struct WorkerHandle {
+        int pid;
+        int socket;
+        uint32_t rowBegin;
+        uint32_t rowEnd;
+        uint32_t columnBegin;
+        uint32_t columnEnd;
+    };
+
+    vector<WorkerHandle> workers;
+    uint32_t vertexCount = 0;
+    vector<bool> present;
+    vector<uint32_t> outDegrees;
+
+    static string& executablePath()
+    {
+        static string path;
+        return path;
+    }
+
+#ifndef _WIN32
+    static bool sendAll(int socket, const void* data, size_t bytes)
+    {
+        const char* cursor = static_cast<const char*>(data);
+        while (bytes > 0)
+        {
+#ifdef MSG_NOSIGNAL
+            ssize_t sent = send(socket, cursor, bytes, MSG_NOSIGNAL);
+#else
+            ssize_t sent = write(socket, cursor, bytes);
+#endif
+            if (sent <= 0)
+            {
+                return false;
+            }
+            cursor += sent;
+            bytes -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    static bool receiveAll(int socket, void* data, size_t bytes)
+    {
+        char* cursor = static_cast<char*>(data);
+        while (bytes > 0)
+        {
+            ssize_t received = read(socket, cursor, bytes);
+            if (received <= 0)
+            {
+                return false;
+            }
+            cursor += received;
+            bytes -= static_cast<size_t>(received);
+        }
+        return true;
+    }
+
+    template <typename T>
+    static bool sendMessage(int socket, uint32_t type, const vector<T>& payload)
+    {
+        uint64_t header[2] = { type, payload.size() * sizeof(T) };
+        return sendAll(socket, header, sizeof(header)) && sendAll(socket, payload.data(), header[1]);
+    }
+
+    template <typename T>
+    static bool receiveMessage(int socket, uint32_t& type, vector<T>& payload)
+    {
+        uint64_t header[2];
+        if (!receiveAll(socket, header, sizeof(header)))
+        {
+            return false;
+        }
+        type = static_cast<uint32_t>(header[0]);
+        payload.resize(header[1] / sizeof(T));
+        return receiveAll(socket, payload.data(), header[1]);
+    }
+
+    [[noreturn]] static void runWorker(int socket, const WorkerHandle& range, const vector<pair<uint32_t, uint32_t>>& edges)
+    {
+        uint32_t rows = range.rowEnd - range.rowBegin;
+        uint32_t columns = range.columnEnd - range.columnBegin;
+        vector<uint32_t> offsets(rows + 1, 0);
+        vector<uint32_t> targets(edges.size());
+        for (const auto& edge : edges)
+        {
+            ++offsets[edge.first - range.rowBegin + 1];
+        }
+        for (uint32_t r = 0; r < rows; ++r)
+        {
+            offsets[r + 1] += offsets[r];
+        }
+        vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (const auto& edge : edges)
+        {
+            targets[cursor[edge.first - range.rowBegin]++] = edge.second;
+        }
+
+        vector<uint8_t> seen(columns, 0);
+        while (true)
+        {
+            uint32_t type;
+            vector<char> request;
+            if (!receiveMessage(socket, type, request) || type == MESSAGE_SHUTDOWN)
+            {
+                _exit(0);
+            }
+
+            if (type == MESSAGE_BFS_RESET)
+            {
+                fill(seen.begin(), seen.end(), 0);
+                sendMessage(socket, type, vector<uint32_t>());
+            }
+            else if (type == MESSAGE_BFS_STEP)
+            {
+                const uint32_t* frontier = reinterpret_cast<const uint32_t*>(request.data());
+                size_t frontierSize = request.size() / sizeof(uint32_t);
+                vector<uint32_t> discovered;
+                for (size_t i = 0; i < frontierSize; ++i)
+                {
+                    uint32_t local = frontier[i] - range.rowBegin;
+                    for (uint32_t e = offsets[local]; e < offsets[local + 1]; ++e)
+                    {
+                        if (!seen[targets[e] - range.columnBegin])
+                        {
+                            seen[targets[e] - range.columnBegin] = 1;
+                            discovered.push_back(targets[e]);
+                        }
+                    }
+                }
+                sendMessage(socket, type, discovered);
+            }
+            else if (type == MESSAGE_PAGERANK_STEP)
+            {
+                const double* shares = reinterpret_cast<const double*>(request.data());
+                vector<double> sums(columns, 0.0);
+                for (uint32_t r = 0; r < rows; ++r)
+                {
+                    for (uint32_t e = offsets[r]; e < offsets[r + 1]; ++e)
+                    {
+                        sums[targets[e] - range.columnBegin] += shares[r];
+                    }
+                }
+                sendMessage(socket, type, sums);
+            }
+        }
+    }
+#endif
+
+    // Sends every worker its request, then gathers all replies (one superstep).
+    template <typename Request, typename Reply>
+    bool superstep(uint32_t type, const vector<vector<Request>>& requests, vector<vector<Reply>>& replies)
+    {
+#ifdef _WIN32
+        return false;
+#else
+        replies.assign(workers.size(), vector<Reply>());
+        for (size_t w = 0; w < workers.size(); ++w)
+        {
+            if (!sendMessage(workers[w].socket, type, requests[w]))
+            {
+                return false;
+            }
+        }
+        for (size_t w = 0; w < workers.size(); ++w)
+        {
+            uint32_t replyType;
+            if (!receiveMessage(workers[w].socket, replyType, replies[w]) || replyType != type)
+            {
+                return false;
+            }
+        }
+        return true;
+#endif
+    }
+
+public:
+    PartitionedWorkerPool() = default;
+    PartitionedWorkerPool(const PartitionedWorkerPool&) = delete;
+    PartitionedWorkerPool& operator=(const PartitionedWorkerPool&) = delete;
+
+    ~PartitionedWorkerPool()
+    {
+        shutdown();
+    }
+
+    // Records argv[0] so that systems without /proc/self/exe can start workers.
+    static void setExecutablePath(const string& path)
+    {
+        executablePath() = path;
+    }
+
+    // Entry point of a worker process: reads its partition from WORKER_SOCKET and
+    // serves supersteps until the coordinator shuts it down.
+    static int serveWorker()
+    {
+#ifdef _WIN32
+        return 1;
+#else
+        uint32_t type;
+        vector<uint32_t> partition;
+        vector<pair<uint32_t, uint32_t>> edges;
+        if (!receiveMessage(WORKER_SOCKET, type, partition) || type != MESSAGE_PARTITION || partition.size() != 4
+            || !receiveMessage(WORKER_SOCKET, type, edges) || type != MESSAGE_PARTITION)
+        {
+            return 1;
+        }
+        runWorker(WORKER_SOCKET, { -1, WORKER_SOCKET, partition[0], partition[1], partition[2], partition[3] }, edges);
+#endif
+    }
+
+    bool start(const GraphSnapshot& graph, uint32_t workerCount, PartitioningScheme scheme)
+    {
+#ifdef _WIN32
+        cerr << "Error: Worker processes are only supported on POSIX systems.\n";
+        return false;
+#else
+        shutdown();
+        vertexCount = graph.getVertexCount();
+        workerCount = max<uint32_t>(1, workerCount);
+        present.assign(vertexCount, false);
+        outDegrees.assign(vertexCount, 0);
+
+        uint32_t rowsInGrid = 1;
+        if (scheme == PARTITION_2D)
+        {
+            for (uint32_t r = 1; r * r <= workerCount; ++r)
+            {
+                if (workerCount % r == 0)
+                {
+                    rowsInGrid = r;
+                }
+            }
+        }
+        uint32_t columnsInGrid = scheme == PARTITION_2D ? workerCount / rowsInGrid : 1;
+        uint32_t rowBlocks = scheme == PARTITION_2D ? rowsInGrid : workerCount;
+        uint32_t rowSize = max<uint32_t>(1, (vertexCount + rowBlocks - 1) / rowBlocks);
+        uint32_t columnSize = max<uint32_t>(1, (vertexCount + columnsInGrid - 1) / columnsInGrid);
+
+        vector<WorkerHandle> ranges;
+        for (uint32_t r = 0; r < rowBlocks; ++r)
+        {
+            for (uint32_t c = 0; c < columnsInGrid; ++c)
+            {
+                ranges.push_back({ -1, -1, min(vertexCount, r * rowSize), min(vertexCount, (r + 1) * rowSize),
+                    min(vertexCount, c * columnSize), min(vertexCount, (c + 1) * columnSize) });
+            }
+        }
+
+        vector<vector<pair<uint32_t, uint32_t>>> blocks(ranges.size());
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            present[v] = graph.isPresent(v);
+            outDegrees[v] = graph.outEdges(v).size();
+            for (uint32_t neighbor : graph.outEdges(v))
+            {
+                blocks[(v / rowSize) * columnsInGrid + neighbor / columnSize].push_back({ v, neighbor });
+            }
+        }
+
+#ifdef __linux__
+        string program = "/proc/self/exe";
+#else
+        string program = executablePath();
+#endif
+        for (size_t w = 0; w < ranges.size(); ++w)
+        {
+            int sockets[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+            {
+                cerr << "Error: Could not create worker socket.\n";
+                shutdown();
+                return false;
+            }
+            // Only the worker's end is passed on, as WORKER_SOCKET. Every other
+            // socket, including those of earlier workers, is closed on exec.
+            fcntl(sockets[0], F_SETFD, FD_CLOEXEC);
+            fcntl(sockets[1], F_SETFD, FD_CLOEXEC);
+
+            pid_t pid = -1;
+            posix_spawn_file_actions_t actions;
+            posix_spawn_file_actions_init(&actions);
+            posix_spawn_file_actions_adddup2(&actions, sockets[1], WORKER_SOCKET);
+            char* arguments[] = { const_cast<char*>(program.c_str()), const_cast<char*>(WORKER_ARGUMENT), nullptr };
+            int status = posix_spawn(&pid, program.c_str(), &actions, nullptr, arguments, environ);
+            posix_spawn_file_actions_destroy(&actions);
+
+            close(sockets[1]);
+            if (status != 0)
+            {
+                close(sockets[0]);
+                cerr << "Error: Could not start worker process.\n";
+                shutdown();
+                return false;
+            }
+            ranges[w].pid = pid;
+            ranges[w].socket = sockets[0];
+            workers.push_back(ranges[w]);
+
+            vector<uint32_t> partition = { ranges[w].rowBegin, ranges[w].rowEnd, ranges[w].columnBegin, ranges[w].columnEnd };
+            if (!sendMessage(sockets[0], MESSAGE_PARTITION, partition) || !sendMessage(sockets[0], MESSAGE_PARTITION, blocks[w]))
+            {
+                cerr << "Error: Could not send a partition to worker process.\n";
+                shutdown();
+                return false;
+            }
+            vector<pair<uint32_t, uint32_t>>().swap(blocks[w]);
+        }
+        return true;
+#endif
+    }
+
+    void shutdown()
+    {
+#ifndef _WIN32
+        for (const auto& worker : workers)
+        {
+            sendMessage(worker.socket, MESSAGE_SHUTDOWN, vector<uint32_t>());
+            close(worker.socket);
+            waitpid(worker.pid, nullptr, 0);
+        }
+#endif
+        workers.clear();
+    }
+
+    size_t getWorkerCount() const
+    {
+        return workers.size();
+    }
+
+    vector<int32_t> breadthFirstSearch(uint32_t source)
+    {
+        vector<int32_t> distance(vertexCount, -1);
+        vector<vector<uint32_t>> requests(workers.size());
+        vector<vector<uint32_t>> replies;
+        if (!superstep(MESSAGE_BFS_RESET, requests, replies))
+        {
+            return distance;
+        }
+
+        vector<uint32_t> frontier = { source };
+        distance[source] = 0;
+        for (int32_t level = 0; !frontier.empty(); ++level)
+        {
+            for (size_t w = 0; w < workers.size(); ++w)
+            {
+                requests[w].clear();
+                for (uint32_t v : frontier)
+                {
+                    if (v >= workers[w].rowBegin && v < workers[w].rowEnd)
+                    {
+                        requests[w].push_back(v);
+                    }
+                }
+            }
+            if (!superstep(MESSAGE_BFS_STEP, requests, replies))
+            {
+                break;
+            }
+
+            frontier.clear();
+            for (const auto& discovered : replies)
+            {
+                for (uint32_t v : discovered)
+                {
+                    if (distance[v] < 0)
+                    {
+                        distance[v] = level + 1;
+                        frontier.push_back(v);
+                    }
+                }
+            }
+        }
+        return distance;
+    }
+
+    vector<double> communicationCentrality()
+    {
+        vector<double> centrality(vertexCount, 0.0);
+        for (uint32_t source = 0; source < vertexCount; ++source)
+        {
+            if (!present[source])
+            {
+                continue;
+            }
+            vector<int32_t> distance = breadthFirstSearch(source);
+            for (uint32_t v = 0; v < vertexCount; ++v)
+            {
+                if (distance[v] > 0)
+                {
+                    centrality[v] += 1.0;
+                }
+            }
+        }
+        return centrality;
+    }
+
+    vector<double> pageRank(int iterations, double damping = 0.85)
+    {
+        uint32_t presentCount = static_cast<uint32_t>(count(present.begin(), present.end(), true));
+        vector<double> rank(vertexCount, 0.0);
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            rank[v] = present[v] ? 1.0 / presentCount : 0.0;
+        }
+
+        vector<vector<double>> requests(workers.size());
+        vector<vector<double>> replies;
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            double danglingMass = 0.0;
+            for (uint32_t v = 0; v < vertexCount; ++v)
+            {
+                if (outDegrees[v] == 0)
+                {
+                    danglingMass += rank[v];
+                }
+            }
+            for (size_t w = 0; w < workers.size(); ++w)
+            {
+                requests[w].assign(workers[w].rowEnd - workers[w].rowBegin, 0.0);
+                for (uint32_t v = workers[w].rowBegin; v < workers[w].rowEnd; ++v)
+                {
+                    requests[w][v - workers[w].rowBegin] = outDegrees[v] > 0 ? damping * rank[v] / outDegrees[v] : 0.0;
+                }
+            }
+            if (!superstep(MESSAGE_PAGERANK_STEP, requests, replies))
+            {
+                break;
+            }
+
+            double base = (1.0 - damping + damping * danglingMass) / max<uint32_t>(1, presentCount);
+            for (uint32_t v = 0; v < vertexCount; ++v)
+            {
+                rank[v] = present[v] ? base : 0.0;
+            }
+            for (size_t w = 0; w < workers.size(); ++w)
+            {
+                for (size_t i = 0; i < replies[w].size(); ++i)
+                {
+                    rank[workers[w].columnBegin + i] += replies[w][i];
+                }
+            }
+        }
+        return rank;
+    }
+};
+
+// Landmark distance table for A* with ALT lower bounds. Relationships are treated as
+// undirected, so |d(L, t) - d(L, v)| never overestimates d(v, t) for any landmark L.
+class LandmarkIndex {
+
+private:
+    uint64_t version = 0;
+    vector<uint32_t> landmarks;
+    vector<vector<double>> distances;
+    bool negativeWeights = false;
+
+    static vector<double> dijkstra(const GraphSnapshot& graph, uint32_t source, bool& negative)
+    {
+        vector<double> distance(graph.getVertexCount(), numeric_limits<double>::infinity());
+        priority_queue<pair<double, uint32_t>, vector<pair<double, uint32_t>>, greater<>> pq;
+        distance[source] = 0.0;
+        pq.push({ 0.0, source });
+
+        while (!pq.empty())
+        {
+            auto [cost, current] = pq.top();
+            pq.pop();
+            if (cost > distance[current])
+            {
+                continue;
+            }
+            for (AdjacencyRange adjacency : { graph.outEdges(current), graph.inEdges(current) })
+            {
+                for (uint32_t i = 0; i < adjacency.size(); ++i)
+                {
+                    negative = negative || adjacency.weights[i] < 0;
+                    double candidate = cost + max(0.0, adjacency.weights[i]);
+                    if (candidate < distance[adjacency.vertices[i]])
+                    {
+                        distance[adjacency.vertices[i]] = candidate;
+                        pq.push({ candidate, adjacency.vertices[i] });
+                    }
+                }
+            }
+        }
+        return distance;
+    }
+
+public:
+    // Picks the highest-degree vertex first, then repeatedly the vertex farthest
+    // from every landmark chosen so far (unreached components first).
+    static LandmarkIndex build(const GraphSnapshot& graph, uint32_t landmarkCount)
+    {
+        LandmarkIndex index;
+        index.version = graph.getVersion();
+        uint32_t vertexCount = graph.getVertexCount();
+        vector<double> nearest(vertexCount, numeric_limits<double>::infinity());
+
+        int first = -1;
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            if (graph.isPresent(v) && (first < 0
+                || graph.outEdges(v).size() + graph.inEdges(v).size() > graph.outEdges(first).size() + graph.inEdges(first).size()))
+            {
+                first = static_cast<int>(v);
+            }
+        }
+
+        int next = first;
+        while (next >= 0 && index.landmarks.size() < landmarkCount)
+        {
+            index.landmarks.push_back(static_cast<uint32_t>(next));
+            index.distances.push_back(dijkstra(graph, static_cast<uint32_t>(next), index.negativeWeights));
+            const vector<double>& latest = index.distances.back();
+
+            next = -1;
+            for (uint32_t v = 0; v < vertexCount; ++v)
+            {
+                nearest[v] = min(nearest[v], latest[v]);
+                bool connected = graph.outEdges(v).size() + graph.inEdges(v).size() > 0;
+                if (graph.isPresent(v) && connected && nearest[v] > 0 && (next < 0 || nearest[v] > nearest[next]))
+                {
+                    next = static_cast<int>(v);
+                }
+            }
+        }
+        return index;
+    }
+
+    uint64_t getVersion() const
+    {
+        return version;
+    }
+
+    bool hasNegativeWeights() const
+    {
+        return negativeWeights;
+    }
+
+    size_t getLandmarkCount() const
+    {
+        return landmarks.size();
+    }
+
+    double lowerBound(uint32_t v, uint32_t target) const
+    {
+        double bound = 0.0;
+        for (const auto& distance : distances)
+        {
+            bool vReached = distance[v] != numeric_limits<double>::infinity();
+            bool targetReached = distance[target] != numeric_limits<double>::infinity();
+            if (vReached != targetReached)
+            {
+                return numeric_limits<double>::infinity();
+            }
+            if (vReached)
+            {
+                bound = max(bound, fabs(distance[target] - distance[v]));
+            }
+        }
+        return bound;
+    }
+};
+
+// Point-to-point queries over undirected relationships. Scratch arrays are reused
+// across queries and reset lazily by stamping, so a query touches only the
+// vertices it actually visits. Not thread-safe; use one engine per thread.
+class PathQueryEngine {
+
+private:
+    vector<uint32_t> forwardStamp;
+    vector<uint32_t> backwardStamp;
+    vector<int32_t> forwardDistance;
+    vector<int32_t> backwardDistance;
+    vector<uint32_t> settledStamp;
+    vector<double> bestDistance;
+    vector<uint32_t> forwardFrontier;
+    vector<uint32_t> backwardFrontier;
+    vector<uint32_t> nextFrontier;
+    uint32_t stamp = 0;
+
+    void beginQuery(uint32_t vertexCount)
+    {
+        if (forwardStamp.size() < vertexCount)
+        {
+            forwardStamp.resize(vertexCount, 0);
+            backwardStamp.resize(vertexCount, 0);
+            forwardDistance.resize(vertexCount, 0);
+            backwardDistance.resize(vertexCount, 0);
+            settledStamp.resize(vertexCount, 0);
+            bestDistance.resize(vertexCount, 0.0);
+        }
+        if (++stamp == 0)
+        {
+            fill(forwardStamp.begin(), forwardStamp.end(), 0);
+            fill(backwardStamp.begin(), backwardStamp.end(), 0);
+            fill(settledStamp.begin(), settledStamp.end(), 0);
+            stamp = 1;
+        }
+    }
+
+    // Expands one complete BFS level of one side; returns the shortest meeting length found.
+    int32_t expandLevel(const GraphSnapshot& graph, vector<uint32_t>& frontier, vector<uint32_t>& ownStamp,
+        vector<int32_t>& ownDistance, const vector<uint32_t>& otherStamp, const vector<int32_t>& otherDistance)
+    {
+        int32_t best = -1;
+        nextFrontier.clear();
+        for (uint32_t current : frontier)
+        {
+            for (const AdjacencyRange& adjacency : { graph.outEdges(current), graph.inEdges(current) })
+            {
+                for (uint32_t neighbor : adjacency)
+                {
+                    if (otherStamp[neighbor] == stamp)
+                    {
+                        int32_t length = ownDistance[current] + 1 + otherDistance[neighbor];
+                        best = best < 0 ? length : min(best, length);
+                    }
+                    if (ownStamp[neighbor] != stamp)
+                    {
+                        ownStamp[neighbor] = stamp;
+                        ownDistance[neighbor] = ownDistance[current] + 1;
+                        nextFrontier.push_back(neighbor);
+                    }
+                }
+            }
+        }
+        frontier.swap(nextFrontier);
+        return best;
+    }
+
+public:
+    // Bidirectional BFS that always grows the side with the smaller frontier.
+    // Returns -1 when target is unreachable.
+    int32_t hops(const GraphSnapshot& graph, uint32_t source, uint32_t target)
+    {
+        if (source == target)
+        {
+            return 0;
+        }
+        beginQuery(graph.getVertexCount());
+        forwardStamp[source] = stamp;
+        forwardDistance[source] = 0;
+        backwardStamp[target] = stamp;
+        backwardDistance[target] = 0;
+        forwardFrontier.assign(1, source);
+        backwardFrontier.assign(1, target);
+
+        while (!forwardFrontier.empty() && !backwardFrontier.empty())
+        {
+            int32_t best = forwardFrontier.size() <= backwardFrontier.size()
+                ? expandLevel(graph, forwardFrontier, forwardStamp, forwardDistance, backwardStamp, backwardDistance)
+                : expandLevel(graph, backwardFrontier, backwardStamp, backwardDistance, forwardStamp, forwardDistance);
+            if (best >= 0)
+            {
+                return best;
+            }
+        }
+        return -1;
+    }
+
+    // A* over relationship weights with landmark lower bounds; plain Dijkstra
+    // when index is null. Returns infinity when unreachable and sets negative if a
+    // negative weight is met, since neither search is valid then.
+    double weightedDistance(const GraphSnapshot& graph, uint32_t source, uint32_t target,
+        const LandmarkIndex* index, bool& negative)
+    {
+        negative = false;
+        beginQuery(graph.getVertexCount());
+        auto bound = [index, target](uint32_t v) { return index != nullptr ? index->lowerBound(v, target) : 0.0; };
+        priority_queue<pair<double, uint32_t>, vector<pair<double, uint32_t>>, greater<>> pq;
+        forwardStamp[source] = stamp;
+        bestDistance[source] = 0.0;
+        pq.push({ bound(source), source });
+
+        while (!pq.empty())
+        {
+            uint32_t current = pq.top().second;
+            pq.pop();
+            if (settledStamp[current] == stamp)
+            {
+                continue;
+            }
+            settledStamp[current] = stamp;
+            if (current == target)
+            {
+                return bestDistance[current];
+            }
+
+            for (const AdjacencyRange& adjacency : { graph.outEdges(current), graph.inEdges(current) })
+            {
+                for (uint32_t i = 0; i < adjacency.size(); ++i)
+                {
+                    uint32_t neighbor = adjacency.vertices[i];
+                    if (adjacency.weights[i] < 0)
+                    {
+                        negative = true;
+                        return numeric_limits<double>::infinity();
+                    }
+                    double candidate = bestDistance[current] + adjacency.weights[i];
+                    if (forwardStamp[neighbor] != stamp || candidate < bestDistance[neighbor])
+                    {
+                        forwardStamp[neighbor] = stamp;
+                        bestDistance[neighbor] = candidate;
+                        double estimate = candidate + bound(neighbor);
+                        if (estimate != numeric_limits<double>::infinity())
+                        {
+                            pq.push({ estimate, neighbor });
+                        }
+                    }
+                }
+            }
+        }
+        return numeric_limits<double>::infinity();
+    }
+};
+
+// Identifies a graph independently of its vertex ids: the vertex and relationship
+// counts plus an order-independent hash over every name and every relationship's
+// endpoint names. Used to tell whether stored labels still describe a graph.
+struct GraphFingerprint {
+    uint64_t vertexCount = 0;
+    uint64_t edgeCount = 0;
+    uint64_t hash = 0;
+
+    static uint64_t hashName(const string& name)
+    {
+        uint64_t h = 0xCBF29CE484222325ULL;
+        for (unsigned char c : name)
+        {
+            h = (h ^ c) * 0x100000001B3ULL;
+        }
+        return h;
+    }
+
+    static GraphFingerprint of(const GraphSnapshot& graph)
+    {
+        GraphFingerprint result;
+        uint32_t vertexCount = graph.getVertexCount();
+        vector<uint64_t> nameHashes(vertexCount, 0);
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            if (graph.isPresent(v))
+            {
+                nameHashes[v] = hashName(graph.getName(v));
+                result.hash += nameHashes[v];
+                ++result.vertexCount;
+            }
+        }
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            for (uint32_t neighbor : graph.outEdges(v))
+            {
+                uint64_t h = (nameHashes[v] * 0x9E3779B97F4A7C15ULL) ^ nameHashes[neighbor];
+                result.hash += h ^ (h >> 29);
+                ++result.edgeCount;
+            }
+        }
+        return result;
+    }
+
+    bool operator==(const GraphFingerprint& other) const
+    {
+        return vertexCount == other.vertexCount && edgeCount == other.edgeCount && hash == other.hash;
+    }
+};
+
+// Exact hop-distance oracle over undirected relationships built with pruned
+// landmark labeling. Vertices are processed in decreasing degree order; each one
+// runs a BFS that stops at every vertex whose distance the labels built so far
+// already cover. A query merges the two sorted labels of its endpoints.
+class DistanceOracle {
+
+private:
+    static constexpr uint8_t UNREACHED = 255;
+    static constexpr uint64_t FILE_MAGIC = 0x32304C4C5053ULL;
+
+    uint64_t version = 0;
+    GraphFingerprint fingerprint;
+    vector<string> names;
+    unordered_map<string, uint32_t> ids;
+    vector<uint64_t> labelOffsets;
+    vector<uint32_t> labelHubs;
+    vector<uint8_t> labelDistances;
+    double buildSeconds = 0.0;
+
+public:
+    bool build(const GraphSnapshot& graph)
+    {
+        auto started = chrono::steady_clock::now();
+        uint32_t vertexCount = graph.getVertexCount();
+        auto degree = [&graph](uint32_t v) { return graph.outEdges(v).size() + graph.inEdges(v).size(); };
+
+        vector<uint32_t> order;
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            if (graph.isPresent(v))
+            {
+                order.push_back(v);
+            }
+        }
+        stable_sort(order.begin(), order.end(), [&degree](uint32_t a, uint32_t b) { return degree(a) > degree(b); });
+
+        vector<vector<pair<uint32_t, uint8_t>>> labels(vertexCount);
+        vector<uint8_t> rootDistance(order.size(), UNREACHED);
+        vector<int32_t> distance(vertexCount, -1);
+        vector<uint32_t> visited;
+
+        for (uint32_t rank = 0; rank < order.size(); ++rank)
+        {
+            uint32_t root = order[rank];
+            for (const auto& entry : labels[root])
+            {
+                rootDistance[entry.first] = entry.second;
+            }
+
+            visited.assign(1, root);
+            distance[root] = 0;
+            for (size_t head = 0; head < visited.size(); ++head)
+            {
+                uint32_t current = visited[head];
+                int32_t d = distance[current];
+                bool covered = false;
+                for (const auto& entry : labels[current])
+                {
+                    if (rootDistance[entry.first] != UNREACHED && rootDistance[entry.first] + entry.second <= d)
+                    {
+                        covered = true;
+                        break;
+                    }
+                }
+                if (covered)
+                {
+                    continue;
+                }
+                if (d >= UNREACHED)
+                {
+                    cerr << "Error: Graph diameter is too large for the distance oracle.\n";
+                    return false;
+                }
+
+                labels[current].push_back({ rank, static_cast<uint8_t>(d) });
+                for (const AdjacencyRange& adjacency : { graph.outEdges(current), graph.inEdges(current) })
+                {
+                    for (uint32_t neighbor : adjacency)
+                    {
+                        if (distance[neighbor] < 0)
+                        {
+                            distance[neighbor] = d + 1;
+                            visited.push_back(neighbor);
+                        }
+                    }
+                }
+            }
+
+            for (uint32_t v : visited)
+            {
+                distance[v] = -1;
+            }
+            for (const auto& entry : labels[root])
+            {
+                rootDistance[entry.first] = UNREACHED;
+            }
+        }
+
+        version = graph.getVersion();
+        fingerprint = GraphFingerprint::of(graph);
+        names.assign(vertexCount, "");
+        ids.clear();
+        labelOffsets.assign(vertexCount + 1, 0);
+        labelHubs.clear();
+        labelDistances.clear();
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            if (graph.isPresent(v))
+            {
+                names[v] = graph.getName(v);
+                ids[names[v]] = v;
+            }
+            for (const auto& entry : labels[v])
+            {
+                labelHubs.push_back(entry.first);
+                labelDistances.push_back(entry.second);
+            }
+            labelOffsets[v + 1] = labelHubs.size();
+            vector<pair<uint32_t, uint8_t>>().swap(labels[v]);
+        }
+        buildSeconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        return true;
+    }
+
+    // Returns the hop distance between u and v, or -1 if they are not connected.
+    int32_t query(uint32_t u, uint32_t v) const
+    {
+        uint64_t i = labelOffsets[u], iEnd = labelOffsets[u + 1];
+        uint64_t j = labelOffsets[v], jEnd = labelOffsets[v + 1];
+        int32_t best = -1;
+        while (i < iEnd && j < jEnd)
+        {
+            if (labelHubs[i] < labelHubs[j])
+            {
+                ++i;
+            }
+            else if (labelHubs[i] > labelHubs[j])
+            {
+                ++j;
+            }
+            else
+            {
+                int32_t length = labelDistances[i++] + labelDistances[j++];
+                best = best < 0 ? length : min(best, length);
+            }
+        }
+        return best;
+    }
+
+    bool findVertex(const string& name, uint32_t& v) const
+    {
+        auto it = ids.find(name);
+        if (it == ids.end())
+        {
+            return false;
+        }
+        v = it->second;
+        return true;
+    }
+
+    uint64_t getVersion() const
+    {
+        return version;
+    }
+
+    void setVersion(uint64_t v)
+    {
+        version = v;
+    }
+
+    bool isBuilt() const
+    {
+        return !labelOffsets.empty();
+    }
+
+    size_t getLabelEntryCount() const
+    {
+        return labelHubs.size();
+    }
+
+    size_t getMemoryBytes() const
+    {
+        return labelOffsets.capacity() * sizeof(uint64_t) + labelHubs.capacity() * sizeof(uint32_t)
+            + labelDistances.capacity();
+    }
+
+    double getBuildSeconds() const
+    {
+        return buildSeconds;
+    }
+
+    uint32_t getVertexCount() const
+    {
+        return static_cast<uint32_t>(names.size());
+    }
+
+    bool save(const string& path) const
+    {
+        ofstream outFile(path, ios::binary | ios::trunc);
+        uint64_t header[6] = { FILE_MAGIC, names.size(), labelHubs.size(),
+            fingerprint.vertexCount, fingerprint.edgeCount, fingerprint.hash };
+        outFile.write(reinterpret_cast<const char*>(header), sizeof(header));
+        for (const auto& name : names)
+        {
+            uint32_t length = static_cast<uint32_t>(name.size());
+            outFile.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            outFile.write(name.data(), length);
+        }
+        outFile.write(reinterpret_cast<const char*>(labelOffsets.data()), labelOffsets.size() * sizeof(uint64_t));
+        outFile.write(reinterpret_cast<const char*>(labelHubs.data()), labelHubs.size() * sizeof(uint32_t));
+        outFile.write(reinterpret_cast<const char*>(labelDistances.data()), labelDistances.size());
+        return outFile.good();
+    }
+
+    // Replaces the oracle with the one stored at path if that file is well formed
+    // and was built from a graph with the expected fingerprint. On failure the
+    // current oracle is left untouched.
+    bool load(const string& path, const GraphFingerprint& expected)
+    {
+        error_code error;
+        uint64_t remaining = filesystem::file_size(path, error);
+        ifstream inFile(path, ios::binary);
+        uint64_t header[6];
+        if (error || !inFile.read(reinterpret_cast<char*>(header), sizeof(header)) || header[0] != FILE_MAGIC)
+        {
+            cerr << "Error: " << path << " is not a distance oracle file.\n";
+            return false;
+        }
+        GraphFingerprint stored;
+        stored.vertexCount = header[3];
+        stored.edgeCount = header[4];
+        stored.hash = header[5];
+        if (!(stored == expected))
+        {
+            cerr << "Error: " << path << " was built from a different graph.\n";
+            return false;
+        }
+
+        uint64_t vertexCount = header[1];
+        uint64_t entryCount = header[2];
+        remaining -= sizeof(header);
+        auto corrupt = [&path]()
+        {
+            cerr << "Error: " << path << " is truncated or corrupt.\n";
+            return false;
+        };
+        if (vertexCount >= numeric_limits<uint32_t>::max() || vertexCount * sizeof(uint32_t) > remaining)
+        {
+            return corrupt();
+        }
+
+        vector<string> loadedNames(vertexCount);
+        unordered_map<string, uint32_t> loadedIds;
+        for (uint64_t v = 0; v < vertexCount; ++v)
+        {
+            uint32_t length;
+            if (!inFile.read(reinterpret_cast<char*>(&length), sizeof(length)) || length > remaining)
+            {
+                return corrupt();
+            }
+            remaining -= sizeof(length);
+            loadedNames[v].resize(length);
+            if (length > 0 && !inFile.read(&loadedNames[v][0], length))
+            {
+                return corrupt();
+            }
+            remaining -= length;
+            if (!loadedNames[v].empty())
+            {
+                loadedIds[loadedNames[v]] = static_cast<uint32_t>(v);
+            }
+        }
+
+        if (remaining != (vertexCount + 1) * sizeof(uint64_t) + entryCount * (sizeof(uint32_t) + sizeof(uint8_t)))
+        {
+            return corrupt();
+        }
+        vector<uint64_t> loadedOffsets(vertexCount + 1);
+        vector<uint32_t> loadedHubs(entryCount);
+        vector<uint8_t> loadedDistances(entryCount);
+        inFile.read(reinterpret_cast<char*>(loadedOffsets.data()), loadedOffsets.size() * sizeof(uint64_t));
+        inFile.read(reinterpret_cast<char*>(loadedHubs.data()), loadedHubs.size() * sizeof(uint32_t));
+        inFile.read(reinterpret_cast<char*>(loadedDistances.data()), loadedDistances.size());
+        if (!inFile || loadedOffsets.front() != 0 || loadedOffsets.back() != entryCount)
+        {
+            return corrupt();
+        }
+        for (uint64_t v = 0; v < vertexCount; ++v)
+        {
+            if (loadedOffsets[v] > loadedOffsets[v + 1])
+            {
+                return corrupt();
+            }
+        }
+        for (uint32_t hub : loadedHubs)
+        {
+            if (hub >= vertexCount)
+            {
+                return corrupt();
+            }
+        }
+
+        fingerprint = stored;
+        names = move(loadedNames);
+        ids = move(loadedIds);
+        labelOffsets = move(loadedOffsets);
+        labelHubs = move(loadedHubs);
+        labelDistances = move(loadedDistances);
+        return true;
+    }
+};
+
+// Fixed pool of worker threads with one task deque each. A worker pops its own
+// newest task and steals the oldest task of another worker when it runs dry; a
+// thread waiting in parallelFor runs queued tasks instead of blocking.
+class TaskScheduler {
+
+private:
+    struct WorkerQueue {
+        mutex lock;
+        deque<function<void()>> tasks;
+    };
+
+    vector<unique_ptr<WorkerQueue>> queues;
+    vector<thread> workers;
+    mutex sleepMutex;
+    condition_variable wake;
+    atomic<size_t> queuedTasks{ 0 };
+    atomic<uint32_t> nextQueue{ 0 };
+    bool stopping = false;
+    inline static thread_local int workerIndex = -1;
+
+    bool tryRunTask()
+    {
+        function<void()> task;
+        uint32_t queueCount = static_cast<uint32_t>(queues.size());
+        if (workerIndex >= 0)
+        {
+            WorkerQueue& own = *queues[workerIndex];
+            lock_guard<mutex> lock(own.lock);
+            if (!own.tasks.empty())
+            {
+                task = move(own.tasks.back());
+                own.tasks.pop_back();
+            }
+        }
+
+        uint32_t first = workerIndex >= 0 ? workerIndex + 1 : nextQueue.load();
+        for (uint32_t i = 0; !task && i < queueCount; ++i)
+        {
+            WorkerQueue& victim = *queues[(first + i) % queueCount];
+            lock_guard<mutex> lock(victim.lock);
+            if (!victim.tasks.empty())
+            {
+                task = move(victim.tasks.front());
+                victim.tasks.pop_front();
+            }
+        }
+
+        if (!task)
+        {
+            return false;
+        }
+        --queuedTasks;
+        task();
+        return true;
+    }
+
+    void workerLoop(int index)
+    {
+        workerIndex = index;
+        while (true)
+        {
+            if (tryRunTask())
+            {
+                continue;
+            }
+            unique_lock<mutex> lock(sleepMutex);
+            wake.wait(lock, [this]() { return stopping || queuedTasks.load() > 0; });
+            if (stopping && queuedTasks.load() == 0)
+            {
+                return;
+            }
+        }
+    }
+
+public:
+    explicit TaskScheduler(uint32_t threadCount)
+    {
+        for (uint32_t i = 0; i < threadCount; ++i)
+        {
+            queues.push_back(make_unique<WorkerQueue>());
+        }
+        for (uint32_t i = 0; i < threadCount; ++i)
+        {
+            workers.emplace_back(&TaskScheduler::workerLoop, this, static_cast<int>(i));
+        }
+    }
+
+    ~TaskScheduler()
+    {
+        {
+            lock_guard<mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    // Process-wide pool shared by every parallel analysis.
+    static TaskScheduler& instance()
+    {
+        static TaskScheduler scheduler(max(1u, thread::hardware_concurrency()));
+        return scheduler;
+    }
+
+    uint32_t getWorkerCount() const
+    {
+        return static_cast<uint32_t>(workers.size());
+    }
+
+    void submit(function<void()> task)
+    {
+        {
+            lock_guard<mutex> lock(sleepMutex);
+            ++queuedTasks;
+        }
+        uint32_t target = workerIndex >= 0 ? static_cast<uint32_t>(workerIndex) : nextQueue++ % queues.size();
+        {
+            lock_guard<mutex> lock(queues[target]->lock);
+            queues[target]->tasks.push_back(move(task));
+        }
+        wake.notify_one();
+    }
+
+    // Runs body(begin, end) over [0, count) in chunks of at most grain items and
+    // returns once every chunk has finished.
+    void parallelFor(uint32_t count, uint32_t grain, const function<void(uint32_t, uint32_t)>& body)
+    {
+        grain = max<uint32_t>(1, grain);
+        uint32_t chunks = count / grain + (count % grain != 0);
+        if (chunks <= 1)
+        {
+            if (count > 0)
+            {
+                body(0, count);
+            }
+            return;
+        }
+
+        atomic<uint32_t> remaining{ chunks - 1 };
+        for (uint32_t chunk = 1; chunk < chunks; ++chunk)
+        {
+            uint32_t begin = chunk * grain;
+            uint32_t end = min(count, begin + grain);
+            submit([&body, &remaining, begin, end]()
+                {
+                    body(begin, end);
+                    --remaining;
+                });
+        }
+        body(0, grain);
+        while (remaining.load() > 0)
+        {
+            if (!tryRunTask())
+            {
+                this_thread::yield();
+            }
+        }
+    }
+
+    // Chunk size that gives every worker a few chunks to balance with.
+    uint32_t grainFor(uint32_t count) const
+    {
+        return max<uint32_t>(1, count / (4 * (getWorkerCount() + 1)));
+    }
+};
+
+// Progress and cancellation shared by a background job and the analysis it runs.
+// Analyses poll isCancelled() and return early; a cancelled result is never cached.
+class JobControl {
+
+private:
+    atomic<bool> cancelRequested{ false };
+    atomic<uint64_t> completed{ 0 };
+    atomic<uint64_t> total{ 0 };
+
+public:
+    void cancel()
+    {
+        cancelRequested = true;
+    }
+
+    bool isCancelled() const
+    {
+        return cancelRequested.load(memory_order_relaxed);
+    }
+
+    void setTotal(uint64_t count)
+    {
+        completed = 0;
+        total = count;
+    }
+
+    void advance(uint64_t count = 1)
+    {
+        completed.fetch_add(count, memory_order_relaxed);
+    }
+
+    double getProgress() const
+    {
+        uint64_t all = total.load();
+        return all == 0 ? 0.0 : min(1.0, static_cast<double>(completed.load()) / all);
+    }
+};
+
+enum JobState {
+    JOB_RUNNING,
+    JOB_FINISHED,
+    JOB_CANCELLED
+};
+
+// Analyses running on a dedicated job thread while the caller keeps editing the
+// graph. Jobs wait in their own FIFO queue rather than on the task scheduler's
+// deques, so a thread waiting in parallelFor never picks up a whole job; a job's
+// own loops still spread over the scheduler's workers. Each job writes its report
+// into a buffer that is kept until the job is reaped: only the most recent
+// MAX_FINISHED_JOBS stopped jobs are retained.
+class BackgroundJobs {
+
+private:
+    static constexpr size_t MAX_FINISHED_JOBS = 32;
+
+    struct Job {
+        uint64_t id;
+        string name;
+        JobControl control;
+        atomic<JobState> state{ JOB_RUNNING };
+        string output;
+        chrono::steady_clock::time_point started;
+        atomic<int64_t> elapsedMilliseconds{ -1 };
+    };
+
+    mutable mutex jobsMutex;
+    condition_variable jobStopped;
+    map<uint64_t, shared_ptr<Job>> jobs;
+    uint64_t nextJobId = 1;
+    size_t runningJobs = 0;
+
+    condition_variable jobQueued;
+    deque<function<void()>> queue;
+    thread runner;
+    bool stopping = false;
+
+    void runnerLoop()
+    {
+        while (true)
+        {
+            function<void()> task;
+            {
+                unique_lock<mutex> lock(jobsMutex);
+                jobQueued.wait(lock, [this]() { return stopping || !queue.empty(); });
+                if (queue.empty())
+                {
+                    return;
+                }
+                task = move(queue.front());
+                queue.pop_front();
+            }
+            task();
+        }
+    }
+
+    shared_ptr<Job> find(uint64_t id) const
+    {
+        lock_guard<mutex> lock(jobsMutex);
+        auto it = jobs.find(id);
+        return it == jobs.end() ? nullptr : it->second;
+    }
+
+    static const char* stateName(JobState state)
+    {
+        return state == JOB_RUNNING ? "running" : state == JOB_FINISHED ? "finished" : "cancelled";
+    }
+
+    // Drops the oldest stopped jobs beyond MAX_FINISHED_JOBS.
+    void reapLocked()
+    {
+        size_t stopped = jobs.size() - runningJobs;
+        for (auto it = jobs.begin(); it != jobs.end() && stopped > MAX_FINISHED_JOBS;)
+        {
+            if (it->second->state.load() != JOB_RUNNING)
+            {
+                it = jobs.erase(it);
+                --stopped;
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+public:
+    ~BackgroundJobs()
+    {
+        shutdown();
+        {
+            lock_guard<mutex> lock(jobsMutex);
+            stopping = true;
+        }
+        jobQueued.notify_all();
+        if (runner.joinable())
+        {
+            runner.join();
+        }
+    }
+
+    uint64_t submit(const string& name, function<void(ostream&, JobControl&)> work)
+    {
+        auto job = make_shared<Job>();
+        job->name = name;
+        job->started = chrono::steady_clock::now();
+        function<void()> task = [this, job, work]() mutable
+            {
+                ostringstream out;
+                work(out, job->control);
+                // Release whatever the work holds, such as a pinned snapshot, before
+                // shutdown() can see the job as stopped.
+                work = nullptr;
+                lock_guard<mutex> lock(jobsMutex);
+                job->output = out.str();
+                job->elapsedMilliseconds = chrono::duration_cast<chrono::milliseconds>(
+                    chrono::steady_clock::now() - job->started).count();
+                job->state = job->control.isCancelled() ? JOB_CANCELLED : JOB_FINISHED;
+                --runningJobs;
+                reapLocked();
+                jobStopped.notify_all();
+            };
+
+        {
+            lock_guard<mutex> lock(jobsMutex);
+            job->id = nextJobId++;
+            jobs[job->id] = job;
+            ++runningJobs;
+            reapLocked();
+            queue.push_back(move(task));
+            if (!runner.joinable())
+            {
+                runner = thread(&BackgroundJobs::runnerLoop, this);
+            }
+        }
+        jobQueued.notify_one();
+        return job->id;
+    }
+
+    bool cancel(uint64_t id)
+    {
+        shared_ptr<Job> job = find(id);
+        if (job == nullptr)
+        {
+            return false;
+        }
+        job->control.cancel();
+        return true;
+    }
+
+    // Blocks until the job has stopped; returns false for unknown ids. The lock is
+    // released while waiting, so other callers and the job itself are not held up.
+    bool wait(uint64_t id)
+    {
+        shared_ptr<Job> job = find(id);
+        if (job == nullptr)
+        {
+            return false;
+        }
+        unique_lock<mutex> lock(jobsMutex);
+        jobStopped.wait(lock, [&job]() { return job->state.load() != JOB_RUNNING; });
+        return true;
+    }
+
+    bool isRunning(uint64_t id) const
+    {
+        shared_ptr<Job> job = find(id);
+        return job != nullptr && job->state.load() == JOB_RUNNING;
+    }
+
+    // Prints the report of a finished job, or its state when there is none yet.
+    void displayResult(uint64_t id, ostream& out) const
+    {
+        shared_ptr<Job> job = find(id);
+        if (job == nullptr)
+        {
+            cerr << "Error: Job not found.\n";
+            return;
+        }
+        lock_guard<mutex> lock(jobsMutex);
+        JobState state = job->state.load();
+        if (state != JOB_FINISHED)
+        {
+            out << "Job " << id << " (" << job->name << ") is " << stateName(state) << ".\n";
+            return;
+        }
+        out << job->output;
+    }
+
+    void display(ostream& out) const
+    {
+        lock_guard<mutex> lock(jobsMutex);
+        if (jobs.empty())
+        {
+            out << "No background jobs.\n";
+            return;
+        }
+        for (const auto& jobPair : jobs)
+        {
+            const Job& job = *jobPair.second;
+            JobState state = job.state.load();
+            out << "Job " << job.id << ": " << job.name << " - " << stateName(state);
+            if (state == JOB_RUNNING)
+            {
+                out << " (" << static_cast<int>(job.control.getProgress() * 100) << "%)";
+            }
+            else
+            {
+                out << " in " << job.elapsedMilliseconds.load() << " ms";
+            }
+            out << "\n";
+        }
+    }
+
+    // Cancels every running job and waits for all of them to stop.
+    void shutdown()
+    {
+        unique_lock<mutex> lock(jobsMutex);
+        for (auto& jobPair : jobs)
+        {
+            jobPair.second->control.cancel();
+        }
+        jobStopped.wait(lock, [this]() { return runningJobs == 0; });
+    }
+};
+
+const uint32_t NO_COMPONENT = numeric_limits<uint32_t>::max();
+
+// Component labelling. Labels are dense component numbers per vertex id, with
+// NO_COMPONENT for ids of removed individuals.
+class ConnectedComponents {
+
+private:
+    static void parallelFor(uint32_t count, const function<void(uint32_t, uint32_t)>& body)
+    {
+        TaskScheduler::instance().parallelFor(count, 4096, body);
+    }
+
+    // Hooks the larger of the two roots under the smaller one with a CAS.
+    static void link(atomic<uint32_t>* parent, uint32_t u, uint32_t v)
+    {
+        uint32_t p1 = parent[u].load();
+        uint32_t p2 = parent[v].load();
+        while (p1 != p2)
+        {
+            uint32_t high = max(p1, p2);
+            uint32_t low = min(p1, p2);
+            uint32_t parentOfHigh = parent[high].load();
+            if (parentOfHigh == low)
+            {
+                break;
+            }
+            if (parentOfHigh == high && parent[high].compare_exchange_strong(parentOfHigh, low))
+            {
+                break;
+            }
+            p1 = parent[parent[high].load()].load();
+            p2 = parent[low].load();
+        }
+    }
+
+    static void compress(atomic<uint32_t>* parent, uint32_t vertexCount)
+    {
+        parallelFor(vertexCount, [parent](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t v = begin; v < end; ++v)
+                {
+                    while (parent[v].load() != parent[parent[v].load()].load())
+                    {
+                        parent[v].store(parent[parent[v].load()].load());
+                    }
+                }
+            });
+    }
+
+    static vector<uint32_t> densify(const GraphSnapshot& graph, const vector<uint32_t>& roots)
+    {
+        vector<uint32_t> labels(roots.size(), NO_COMPONENT);
+        unordered_map<uint32_t, uint32_t> numbers;
+        for (uint32_t v = 0; v < roots.size(); ++v)
+        {
+            if (graph.isPresent(v))
+            {
+                labels[v] = numbers.insert({ roots[v], static_cast<uint32_t>(numbers.size()) }).first->second;
+            }
+        }
+        return labels;
+    }
+
+public:
+    // Afforest: link each vertex to its first two out-neighbors in parallel, find the
+    // most common component from a sample, then link all remaining edges only for
+    // vertices outside it.
+    static vector<uint32_t> weak(const GraphSnapshot& graph)
+    {
+        const uint32_t samplingRounds = 2;
+        uint32_t vertexCount = graph.getVertexCount();
+        unique_ptr<atomic<uint32_t>[]> parentStorage(new atomic<uint32_t>[vertexCount]);
+        atomic<uint32_t>* parent = parentStorage.get();
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            parent[v].store(v);
+        }
+
+        for (uint32_t round = 0; round < samplingRounds; ++round)
+        {
+            parallelFor(vertexCount, [&graph, parent, round](uint32_t begin, uint32_t end)
+                {
+                    for (uint32_t v = begin; v < end; ++v)
+                    {
+                        AdjacencyRange adjacency = graph.outEdges(v);
+                        if (round < adjacency.size())
+                        {
+                            link(parent, v, adjacency.vertices[round]);
+                        }
+                    }
+                });
+            compress(parent, vertexCount);
+        }
+
+        uint32_t frequent = vertexCount;
+        if (vertexCount > 0)
+        {
+            unordered_map<uint32_t, uint32_t> sampleCounts;
+            uint32_t step = max<uint32_t>(1, vertexCount / 1024);
+            for (uint32_t v = 0; v < vertexCount; v += step)
+            {
+                ++sampleCounts[parent[v].load()];
+            }
+            frequent = max_element(sampleCounts.begin(), sampleCounts.end(),
+                [](const auto& a, const auto& b) { return a.second < b.second; })->first;
+        }
+
+        parallelFor(vertexCount, [&graph, parent, frequent, samplingRounds](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t v = begin; v < end; ++v)
+                {
+                    if (parent[v].load() == frequent)
+                    {
+                        continue;
+                    }
+                    AdjacencyRange outgoing = graph.outEdges(v);
+                    for (uint32_t i = samplingRounds; i < outgoing.size(); ++i)
+                    {
+                        link(parent, v, outgoing.vertices[i]);
+                    }
+                    for (uint32_t neighbor : graph.inEdges(v))
+                    {
+                        link(parent, v, neighbor);
+                    }
+                }
+            });
+        compress(parent, vertexCount);
+
+        vector<uint32_t> roots(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            roots[v] = parent[v].load();
+        }
+        return densify(graph, roots);
+    }
+
+    // Tarjan's algorithm with an explicit call stack, so deep graphs cannot overflow
+    // the native stack.
+    static vector<uint32_t> strong(const GraphSnapshot& graph)
+    {
+        uint32_t vertexCount = graph.getVertexCount();
+        vector<uint32_t> index(vertexCount, NO_COMPONENT);
+        vector<uint32_t> low(vertexCount, 0);
+        vector<bool> onStack(vertexCount, false);
+        vector<uint32_t> labels(vertexCount, NO_COMPONENT);
+        vector<uint32_t> tarjanStack;
+        vector<pair<uint32_t, uint32_t>> callStack;
+        uint32_t nextIndex = 0;
+        uint32_t nextComponent = 0;
+
+        for (uint32_t root = 0; root < vertexCount; ++root)
+        {
+            if (!graph.isPresent(root) || index[root] != NO_COMPONENT)
+            {
+                continue;
+            }
+
+            index[root] = low[root] = nextIndex++;
+            tarjanStack.push_back(root);
+            onStack[root] = true;
+            callStack.push_back({ root, 0 });
+
+            while (!callStack.empty())
+            {
+                uint32_t v = callStack.back().first;
+                AdjacencyRange adjacency = graph.outEdges(v);
+                if (callStack.back().second < adjacency.size())
+                {
+                    uint32_t w = adjacency.vertices[callStack.back().second++];
+                    if (index[w] == NO_COMPONENT)
+                    {
+                        index[w] = low[w] = nextIndex++;
+                        tarjanStack.push_back(w);
+                        onStack[w] = true;
+                        callStack.push_back({ w, 0 });
+                    }
+                    else if (onStack[w])
+                    {
+                        low[v] = min(low[v], index[w]);
+                    }
+                    continue;
+                }
+
+                callStack.pop_back();
+                if (low[v] == index[v])
+                {
+                    uint32_t w;
+                    do
+                    {
+                        w = tarjanStack.back();
+                        tarjanStack.pop_back();
+                        onStack[w] = false;
+                        labels[w] = nextComponent;
+                    } while (w != v);
+                    ++nextComponent;
+                }
+                if (!callStack.empty())
+                {
+                    uint32_t caller = callStack.back().first;
+                    low[caller] = min(low[caller], low[v]);
+                }
+            }
+        }
+        return labels;
+    }
+
+    static uint32_t countComponents(const vector<uint32_t>& labels)
+    {
+        uint32_t count = 0;
+        for (uint32_t label : labels)
+        {
+            if (label != NO_COMPONENT)
+            {
+                count = max(count, label + 1);
+            }
+        }
+        return count;
+    }
+};
+
+struct LinkCandidate {
+    uint32_t vertex;
+    double score;
+    uint32_t commonNeighbors;
+    double adamicAdar;
+    double jaccard;
+};
+
+struct LinkRecommendations {
+    vector<LinkCandidate> friendsOfFriends;
+    vector<LinkCandidate> randomWalks;
+    uint32_t walks = 0;
+    bool complete = true;
+};
+
+// Link prediction over friendship and collaboration relationships, taken as one
+// undirected graph with sorted neighbor lists. Friends of friends are scored by
+// common neighbors, Adamic-Adar and Jaccard; personalized PageRank is estimated
+// from random walks stitched together from short walk segments precomputed for
+// every individual.
+class LinkPredictor {
+
+public:
+    static constexpr double RESTART_PROBABILITY = 0.15;
+    static constexpr uint32_t SEGMENT_LENGTH = 8;
+    static constexpr uint32_t SEGMENTS_PER_VERTEX = 4;
+    static constexpr uint32_t CANDIDATES_PER_DEADLINE_CHECK = 1024;
+
+private:
+    vector<uint32_t> offsets;
+    vector<uint32_t> targets;
+    vector<uint32_t> segments;
+
+    static bool predicts(uint8_t type)
+    {
+        return type == FRIENDSHIP || type == COLLABORATION;
+    }
+
+    const uint32_t* neighborsBegin(uint32_t v) const
+    {
+        return targets.data() + offsets[v];
+    }
+
+    const uint32_t* neighborsEnd(uint32_t v) const
+    {
+        return targets.data() + offsets[v + 1];
+    }
+
+    // True when target and candidate already share a relationship of any type.
+    static bool related(const GraphSnapshot& graph, uint32_t target, uint32_t candidate)
+    {
+        AdjacencyRange out = graph.outEdges(target);
+        AdjacencyRange in = graph.inEdges(target);
+        return binary_search(out.begin(), out.end(), candidate) || binary_search(in.begin(), in.end(), candidate);
+    }
+
+    uint32_t countCommonNeighbors(uint32_t u, uint32_t v) const
+    {
+        uint32_t common = 0;
+        const uint32_t* a = neighborsBegin(u);
+        const uint32_t* b = neighborsBegin(v);
+        while (a != neighborsEnd(u) && b != neighborsEnd(v))
+        {
+            if (*a < *b)
+            {
+                ++a;
+            }
+            else if (*b < *a)
+            {
+                ++b;
+            }
+            else
+            {
+                ++common;
+                ++a;
+                ++b;
+            }
+        }
+        return common;
+    }
+
+    double jaccard(uint32_t u, uint32_t v, uint32_t common) const
+    {
+        uint32_t together = getDegree(u) + getDegree(v) - common;
+        return together == 0 ? 0.0 : static_cast<double>(common) / together;
+    }
+
+    static void keepTop(vector<LinkCandidate>& candidates, size_t topCount)
+    {
+        auto better = [](const LinkCandidate& a, const LinkCandidate& b)
+            {
+                return a.score != b.score ? a.score > b.score : a.vertex < b.vertex;
+            };
+        size_t kept = min(topCount, candidates.size());
+        partial_sort(candidates.begin(), candidates.begin() + kept, candidates.end(), better);
+        candidates.resize(kept);
+    }
+
+public:
+    explicit LinkPredictor(const GraphSnapshot& graph)
+    {
+        uint32_t vertexCount = graph.getVertexCount();
+        offsets.assign(vertexCount + 1, 0);
+        vector<uint32_t> adjacent;
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            adjacent.clear();
+            if (graph.isPresent(v))
+            {
+                for (AdjacencyRange range : { graph.outEdges(v), graph.inEdges(v) })
+                {
+                    for (uint32_t i = 0; i < range.size(); ++i)
+                    {
+                        if (predicts(range.types[i]) && range.vertices[i] != v)
+                        {
+                            adjacent.push_back(range.vertices[i]);
+                        }
+                    }
+                }
+                sort(adjacent.begin(), adjacent.end());
+                adjacent.erase(unique(adjacent.begin(), adjacent.end()), adjacent.end());
+            }
+            targets.insert(targets.end(), adjacent.begin(), adjacent.end());
+            offsets[v + 1] = static_cast<uint32_t>(targets.size());
+        }
+
+        // Segment s of v lists the vertices after 1..SEGMENT_LENGTH uniform steps from
+        // v. Every neighbor has at least one neighbor of its own, so segments never
+        // stop early; isolated vertices keep a segment that stays in place.
+        segments.resize(static_cast<size_t>(vertexCount) * SEGMENTS_PER_VERTEX * SEGMENT_LENGTH);
+        TaskScheduler& scheduler = TaskScheduler::instance();
+        scheduler.parallelFor(vertexCount, scheduler.grainFor(vertexCount), [this](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t v = begin; v < end; ++v)
+                {
+                    mt19937 random(v);
+                    uint32_t* segment = segments.data() + static_cast<size_t>(v) * SEGMENTS_PER_VERTEX * SEGMENT_LENGTH;
+                    for (uint32_t s = 0; s < SEGMENTS_PER_VERTEX; ++s)
+                    {
+                        uint32_t current = v;
+                        for (uint32_t step = 0; step < SEGMENT_LENGTH; ++step)
+                        {
+                            if (getDegree(current) > 0)
+                            {
+                                current = neighborsBegin(current)[random() % getDegree(current)];
+                            }
+                            *segment++ = current;
+                        }
+                    }
+                }
+            });
+    }
+
+    uint32_t getVertexCount() const
+    {
+        return static_cast<uint32_t>(offsets.size() - 1);
+    }
+
+    uint32_t getDegree(uint32_t v) const
+    {
+        return offsets[v + 1] - offsets[v];
+    }
+
+    // Friends of friends of target ranked by Adamic-Adar. Intermediaries are visited
+    // from the lowest degree up, since they weigh most in Adamic-Adar. The deadline
+    // is checked every CANDIDATES_PER_DEADLINE_CHECK candidates, so one hub cannot
+    // overrun it; whatever is left when it passes is skipped and complete is cleared.
+    vector<LinkCandidate> scoreFriendsOfFriends(const GraphSnapshot& graph, uint32_t target, size_t topCount,
+        chrono::steady_clock::time_point deadline, bool& complete) const
+    {
+        vector<uint32_t> intermediaries(neighborsBegin(target), neighborsEnd(target));
+        sort(intermediaries.begin(), intermediaries.end(),
+            [this](uint32_t a, uint32_t b) { return getDegree(a) < getDegree(b); });
+
+        unordered_map<uint32_t, LinkCandidate> scored;
+        uint32_t untilCheck = 0;
+        bool expired = false;
+        for (uint32_t middle : intermediaries)
+        {
+            if (expired)
+            {
+                complete = false;
+                break;
+            }
+            double weight = 1.0 / log(static_cast<double>(getDegree(middle)));
+            for (const uint32_t* it = neighborsBegin(middle); it != neighborsEnd(middle); ++it)
+            {
+                if (untilCheck-- == 0)
+                {
+                    expired = chrono::steady_clock::now() > deadline;
+                    if (expired)
+                    {
+                        complete = false;
+                        break;
+                    }
+                    untilCheck = CANDIDATES_PER_DEADLINE_CHECK - 1;
+                }
+                if (*it == target)
+                {
+                    continue;
+                }
+                auto inserted = scored.insert({ *it, { *it, 0.0, 0, 0.0, 0.0 } });
+                if (inserted.second && related(graph, target, *it))
+                {
+                    inserted.first->second.commonNeighbors = NO_COMPONENT;
+                }
+                LinkCandidate& candidate = inserted.first->second;
+                if (candidate.commonNeighbors != NO_COMPONENT)
+                {
+                    ++candidate.commonNeighbors;
+                    candidate.adamicAdar += weight;
+                }
+            }
+        }
+
+        vector<LinkCandidate> candidates;
+        for (auto& candidatePair : scored)
+        {
+            LinkCandidate& candidate = candidatePair.second;
+            if (candidate.commonNeighbors != NO_COMPONENT)
+            {
+                candidate.score = candidate.adamicAdar;
+                candidate.jaccard = jaccard(target, candidate.vertex, candidate.commonNeighbors);
+                candidates.push_back(candidate);
+            }
+        }
+        keepTop(candidates, topCount);
+        return candidates;
+    }
+
+    // Monte-Carlo personalized PageRank from target. Each walk restarts with
+    // RESTART_PROBABILITY after every visit; a walk arriving at a vertex follows that
+    // vertex's next unused precomputed segment and only draws single random steps
+    // once this query has used all of them. Stops after walkCount walks or at the
+    // deadline; walks reports how many were run.
+    vector<LinkCandidate> estimatePersonalizedPageRank(const GraphSnapshot& graph, uint32_t target, size_t topCount,
+        uint32_t walkCount, chrono::steady_clock::time_point deadline, uint32_t& walks, bool& complete) const
+    {
+        mt19937 random(target);
+        uniform_real_distribution<double> coin(0.0, 1.0);
+        unordered_map<uint32_t, uint32_t> visits;
+        unordered_map<uint32_t, uint32_t> segmentsUsed;
+
+        for (walks = 0; walks < walkCount; ++walks)
+        {
+            if (walks % 64 == 0 && chrono::steady_clock::now() > deadline)
+            {
+                complete = false;
+                break;
+            }
+
+            uint32_t current = target;
+            while (true)
+            {
+                ++visits[current];
+                if (coin(random) < RESTART_PROBABILITY || getDegree(current) == 0)
+                {
+                    break;
+                }
+                uint32_t& used = segmentsUsed[current];
+                if (used == SEGMENTS_PER_VERTEX)
+                {
+                    current = neighborsBegin(current)[random() % getDegree(current)];
+                    continue;
+                }
+
+                const uint32_t* segment = segments.data()
+                    + (static_cast<size_t>(current) * SEGMENTS_PER_VERTEX + used++) * SEGMENT_LENGTH;
+                current = segment[0];
+                bool restarted = false;
+                for (uint32_t step = 1; step < SEGMENT_LENGTH && !restarted; ++step)
+                {
+                    ++visits[current];
+                    restarted = coin(random) < RESTART_PROBABILITY;
+                    current = restarted ? current : segment[step];
+                }
+                if (restarted)
+                {
+                    break;
+                }
+            }
+        }
+
+        vector<LinkCandidate> candidates;
+        for (const auto& visitPair : visits)
+        {
+            uint32_t v = visitPair.first;
+            if (v == target || related(graph, target, v))
+            {
+                continue;
+            }
+            double rank = RESTART_PROBABILITY * visitPair.second / max<uint32_t>(1, walks);
+            candidates.push_back({ v, rank, 0, 0.0, 0.0 });
+        }
+        keepTop(candidates, topCount);
+        for (LinkCandidate& candidate : candidates)
+        {
+            candidate.commonNeighbors = countCommonNeighbors(target, candidate.vertex);
+            candidate.jaccard = jaccard(target, candidate.vertex, candidate.commonNeighbors);
+        }
+        return candidates;
+    }
+
+    // Runs both scorers for one individual within budget: friends of friends get
+    // the first half and the random walks everything that is left.
+    LinkRecommendations recommend(const GraphSnapshot& graph, uint32_t target, size_t topCount,
+        chrono::microseconds budget, uint32_t walkCount = 4096) const
+    {
+        LinkRecommendations result;
+        auto start = chrono::steady_clock::now();
+        result.friendsOfFriends = scoreFriendsOfFriends(graph, target, topCount, start + budget / 2, result.complete);
+        result.randomWalks = estimatePersonalizedPageRank(graph, target, topCount, walkCount, start + budget,
+            result.walks, result.complete);
+        return result;
+    }
+
+    size_t getMemoryBytes() const
+    {
+        return (offsets.capacity() + targets.capacity() + segments.capacity()) * sizeof(uint32_t);
+    }
+};
+
+// Epoch-based reclamation: readers pin the current epoch while they use a shared
+// object; retired objects are destroyed once no reader pinned an epoch at or
+// before the one in which they were retired.
+class EpochManager {
+
+private:
+    static constexpr int MAX_READERS = 64;
+    atomic<uint64_t> globalEpoch;
+    atomic<uint64_t> readerEpochs[MAX_READERS];
+    mutex retiredMutex;
+    vector<pair<uint64_t, function<void()>>> retired;
+    mutex slotMutex;
+    condition_variable slotFreed;
+    atomic<int> slotWaiters{ 0 };
+
+    int tryClaimSlot()
+    {
+        for (int slot = 0; slot < MAX_READERS; ++slot)
+        {
+            uint64_t expected = 0;
+            if (readerEpochs[slot].compare_exchange_strong(expected, globalEpoch.load()))
+            {
+                return slot;
+            }
+        }
+        return -1;
+    }
+
+    void reclaimLocked()
+    {
+        uint64_t oldestPinned = numeric_limits<uint64_t>::max();
+        for (int slot = 0; slot < MAX_READERS; ++slot)
+        {
+            uint64_t pinned = readerEpochs[slot].load();
+            if (pinned != 0)
+            {
+                oldestPinned = min(oldestPinned, pinned);
+            }
+        }
+
+        auto keep = partition(retired.begin(), retired.end(),
+            [oldestPinned](const pair<uint64_t, function<void()>>& entry) { return entry.first >= oldestPinned; });
+        for (auto it = keep; it != retired.end(); ++it)
+        {
+            it->second();
+        }
+        retired.erase(keep, retired.end());
+    }
+
+public:
+    EpochManager() : globalEpoch(1)
+    {
+        for (int slot = 0; slot < MAX_READERS; ++slot)
+        {
+            readerEpochs[slot].store(0);
+        }
+    }
+
+    ~EpochManager()
+    {
+        for (auto& entry : retired)
+        {
+            entry.second();
+        }
+    }
+
+    // Pins the current epoch and returns the reader slot. When every slot is taken
+    // the caller sleeps until a reader exits instead of spinning.
+    int enter()
+    {
+        return enterWithin(chrono::steady_clock::duration::max());
+    }
+
+    // Like enter(), but gives up after timeout and returns -1.
+    int enterWithin(chrono::steady_clock::duration timeout)
+    {
+        int slot = tryClaimSlot();
+        if (slot >= 0)
+        {
+            return slot;
+        }
+
+        auto deadline = timeout == chrono::steady_clock::duration::max()
+            ? chrono::steady_clock::time_point::max() : chrono::steady_clock::now() + timeout;
+        unique_lock<mutex> lock(slotMutex);
+        ++slotWaiters;
+        while ((slot = tryClaimSlot()) < 0)
+        {
+            if (deadline == chrono::steady_clock::time_point::max())
+            {
+                slotFreed.wait(lock);
+            }
+            else if (slotFreed.wait_until(lock, deadline) == cv_status::timeout && (slot = tryClaimSlot()) < 0)
+            {
+                break;
+            }
+        }
+        --slotWaiters;
+        return slot;
+    }
+
+    void exit(int slot)
+    {
+        readerEpochs[slot].store(0);
+        if (slotWaiters.load() > 0)
+        {
+            lock_guard<mutex> lock(slotMutex);
+            slotFreed.notify_one();
+        }
+    }
+
+    void retire(function<void()> deleter)
+    {
+        lock_guard<mutex> lock(retiredMutex);
+        retired.push_back({ globalEpoch.fetch_add(1), move(deleter) });
+        reclaimLocked();
+    }
+
+    void reclaim()
+    {
+        lock_guard<mutex> lock(retiredMutex);
+        reclaimLocked();
+    }
+
+    size_t getRetiredCount()
+    {
+        lock_guard<mutex> lock(retiredMutex);
+        return retired.size();
+    }
+};
+
+// Keeps one snapshot alive for as long as the guard exists.
+class SnapshotGuard {
+
+private:
+    EpochManager* epochs;
+    int slot;
+    const GraphSnapshot* snapshot;
+
+public:
+    SnapshotGuard(EpochManager& e, const atomic<const GraphSnapshot*>& published)
+        : epochs(&e), slot(e.enter()), snapshot(published.load()) {}
+
+    // Gives up after timeout when every reader slot stays taken; check isPinned().
+    SnapshotGuard(EpochManager& e, const atomic<const GraphSnapshot*>& published, chrono::steady_clock::duration timeout)
+        : epochs(&e), slot(e.enterWithin(timeout)), snapshot(nullptr)
+    {
+        if (slot < 0)
+        {
+            epochs = nullptr;
+        }
+        else
+        {
+            snapshot = published.load();
+        }
+    }
+
+    SnapshotGuard(SnapshotGuard&& other) noexcept
+        : epochs(other.epochs), slot(other.slot), snapshot(other.snapshot)
+    {
+        other.epochs = nullptr;
+    }
+
+    SnapshotGuard(const SnapshotGuard&) = delete;
+    SnapshotGuard& operator=(const SnapshotGuard&) = delete;
+
+    ~SnapshotGuard()
+    {
+        if (epochs != nullptr)
+        {
+            epochs->exit(slot);
+        }
+    }
+
+    bool isPinned() const
+    {
+        return epochs != nullptr;
+    }
+
+    const GraphSnapshot& get() const
+    {
+        return *snapshot;
+    }
+
+    const GraphSnapshot* operator->() const
+    {
+        return snapshot;
+    }
+};
+
+inline size_t estimateBytes(const vector<double>& values)
+{
+    return sizeof(values) + values.capacity() * sizeof(double);
+}
+
+inline size_t estimateBytes(const vector<string>& values)
+{
+    size_t bytes = sizeof(values) + values.capacity() * sizeof(string);
+    for (const auto& value : values)
+    {
+        bytes += value.capacity();
+    }
+    return bytes;
+}
+
+inline size_t estimateBytes(const vector<vector<string>>& groups)
+{
+    size_t bytes = sizeof(groups) + groups.capacity() * sizeof(vector<string>);
+    for (const auto& group : groups)
+    {
+        bytes += estimateBytes(group);
+    }
+    return bytes;
+}
+
+inline size_t estimateBytes(const vector<pair<string, string>>& pairs)
+{
+    size_t bytes = sizeof(pairs) + pairs.capacity() * sizeof(pair<string, string>);
+    for (const auto& p : pairs)
+    {
+        bytes += p.first.capacity() + p.second.capacity();
+    }
+    return bytes;
+}
+
+inline size_t estimateBytes(const CompressedGraph& graph)
+{
+    return graph.getMemoryBytes();
+}
+
+template <typename Weight, typename Direction>
+inline size_t estimateBytes(const TypedGraph<Weight, Direction>& graph)
+{
+    return sizeof(graph) + graph.getMemoryBytes();
+}
+
+inline size_t estimateBytes(const LinkPredictor& predictor)
+{
+    return sizeof(predictor) + predictor.getMemoryBytes();
+}
+
+inline size_t estimateBytes(const vector<uint32_t>& values)
+{
+    return sizeof(values) + values.capacity() * sizeof(uint32_t);
+}
+
+struct SpanningForest {
+    vector<string> roots;
+    vector<vector<pair<string, string>>> trees;
+    size_t isolatedCount = 0;
+};
+
+inline size_t estimateBytes(const SpanningForest& forest)
+{
+    size_t bytes = sizeof(forest) + estimateBytes(forest.roots);
+    for (const auto& tree : forest.trees)
+    {
+        bytes += estimateBytes(tree);
+    }
+    return bytes;
+}
+
+// Memoizes analysis results by (analysis, parameters, graph version). Entries for
+// older graph versions are dropped as soon as a newer version is seen; with a
+// memory budget set, the least recently used entries are evicted first.
+class AnalysisCache {
+
+private:
+    struct CacheEntry {
+        string key;
+        shared_ptr<const void> result;
+        size_t bytes;
+        uint64_t version;
+    };
+
+    list<CacheEntry> entries;
+    unordered_map<string, list<CacheEntry>::iterator> index;
+    mutex cacheMutex;
+    size_t memoryBudget = 0;
+    size_t bytesUsed = 0;
+    uint64_t newestVersion = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    void eraseEntry(list<CacheEntry>::iterator it)
+    {
+        bytesUsed -= it->bytes;
+        index.erase(it->key);
+        entries.erase(it);
+    }
+
+    void evictToBudget()
+    {
+        while (memoryBudget != 0 && bytesUsed > memoryBudget && !entries.empty())
+        {
+            eraseEntry(prev(entries.end()));
+        }
+    }
+
+    void dropOlderThan(uint64_t version)
+    {
+        if (version <= newestVersion)
+        {
+            return;
+        }
+        newestVersion = version;
+        for (auto it = entries.begin(); it != entries.end();)
+        {
+            auto current = it++;
+            if (current->version < version)
+            {
+                eraseEntry(current);
+            }
+        }
+    }
+
+public:
+    template <typename T>
+    shared_ptr<const T> getOrCompute(const string& analysis, const string& parameters, uint64_t version,
+        const function<T()>& compute, const JobControl* control = nullptr)
+    {
+        string key = analysis + '\x1f' + parameters + '\x1f' + to_string(version);
+        {
+            lock_guard<mutex> lock(cacheMutex);
+            dropOlderThan(version);
+            auto it = index.find(key);
+            if (it != index.end())
+            {
+                entries.splice(entries.begin(), entries, it->second);
+                ++hits;
+                return static_pointer_cast<const T>(it->second->result);
+            }
+            ++misses;
+        }
+
+        auto result = make_shared<const T>(compute());
+        if (control != nullptr && control->isCancelled())
+        {
+            return result;
+        }
+        size_t bytes = estimateBytes(*result) + key.capacity();
+
+        lock_guard<mutex> lock(cacheMutex);
+        if (version < newestVersion || index.find(key) != index.end()
+            || (memoryBudget != 0 && bytes > memoryBudget))
+        {
+            return result;
+        }
+        entries.push_front({ key, result, bytes, version });
+        index[key] = entries.begin();
+        bytesUsed += bytes;
+        evictToBudget();
+        return result;
+    }
+
+    // Drops every cached version of one analysis and parameter set.
+    void erase(const string& analysis, const string& parameters)
+    {
+        string prefix = analysis + '\x1f' + parameters + '\x1f';
+        lock_guard<mutex> lock(cacheMutex);
+        for (auto it = entries.begin(); it != entries.end();)
+        {
+            auto current = it++;
+            if (current->key.compare(0, prefix.size(), prefix) == 0)
+            {
+                eraseEntry(current);
+            }
+        }
+    }
+
+    void setMemoryBudget(size_t bytes)
+    {
+        lock_guard<mutex> lock(cacheMutex);
+        memoryBudget = bytes;
+        evictToBudget();
+    }
+
+    void clear()
+    {
+        lock_guard<mutex> lock(cacheMutex);
+        entries.clear();
+        index.clear();
+        bytesUsed = 0;
+    }
+
+    void displayStatistics()
+    {
+        lock_guard<mutex> lock(cacheMutex);
+        cout << "Analysis cache: " << entries.size() << " entries, " << bytesUsed << " bytes used, budget "
+            << (memoryBudget == 0 ? string("unlimited") : to_string(memoryBudget) + " bytes")
+            << ", " << hits << " hits, " << misses << " misses\n";
+    }
+};
+
+// Scratch state for one source of Brandes' algorithm: a BFS that counts shortest
+// paths, then dependency accumulation over out-edges in reverse BFS order.
+// Shared by the full betweenness computation and dynamic centrality.
+struct BrandesPass {
+    vector<int32_t> distance;
+    vector<double> numShortestPaths;
+    vector<double> dependency;
+    vector<uint32_t> order;
+
+    void resize(uint32_t vertexCount)
+    {
+        distance.resize(vertexCount, -1);
+        numShortestPaths.resize(vertexCount, 0.0);
+        dependency.resize(vertexCount, 0.0);
+        order.reserve(vertexCount);
+    }
+
+    // Calls visit(v, dependency of v) for every vertex reachable from source other
+    // than source itself and returns the sum of their distances. The visited
+    // vertices are left in order until the next run.
+    template <typename Graph, typename Visit>
+    double run(const Graph& graph, uint32_t source, Visit visit)
+    {
+        order.clear();
+        order.push_back(source);
+        distance[source] = 0;
+        numShortestPaths[source] = 1.0;
+        double distanceSum = 0.0;
+
+        for (size_t head = 0; head < order.size(); ++head)
+        {
+            uint32_t current = order[head];
+            distanceSum += distance[current];
+            graph.forEachOutNeighbor(current, [&](uint32_t neighbor)
+                {
+                    if (distance[neighbor] < 0)
+                    {
+                        distance[neighbor] = distance[current] + 1;
+                        order.push_back(neighbor);
+                    }
+                    if (distance[neighbor] == distance[current] + 1)
+                    {
+                        numShortestPaths[neighbor] += numShortestPaths[current];
+                    }
+                });
+        }
+
+        for (auto it = order.rbegin(); it != order.rend(); ++it)
+        {
+            uint32_t current = *it;
+            graph.forEachOutNeighbor(current, [&](uint32_t successor)
+                {
+                    if (distance[successor] == distance[current] + 1)
+                    {
+                        dependency[current] += (numShortestPaths[current] / numShortestPaths[successor]) *
+                            (1 + dependency[successor]);
+                    }
+                });
+            if (current != source)
+            {
+                visit(current, dependency[current]);
+            }
+        }
+
+        for (uint32_t v : order)
+        {
+            distance[v] = -1;
+            numShortestPaths[v] = 0.0;
+            dependency[v] = 0.0;
+        }
+        return distanceSum;
+    }
+};
+
+// Keeps closeness, betweenness and communication (reachability) centrality current
+// under edge insertions and deletions over directed, unweighted relationships.
+// An update recomputes only the sources whose shortest-path DAG can change: on
+// insertion of u->v those with d(s,u) + 1 <= d(s,v), on deletion those with
+// d(s,u) + 1 == d(s,v). The old contribution of each affected source is
+// subtracted before the change and its new contribution added afterwards.
+// d(s,u) and d(s,v) for every s come from two reverse BFS passes per update, so
+// memory stays linear in the graph instead of holding a distance matrix.
+class DynamicCentrality {
+
+private:
+    vector<string> names;
+    vector<bool> present;
+    vector<vector<uint32_t>> outAdjacency;
+    vector<vector<uint32_t>> inAdjacency;
+    vector<double> betweenness;
+    vector<double> closeness;
+    vector<double> reach;
+    vector<int32_t> distanceToU;
+    vector<int32_t> distanceToV;
+    vector<uint32_t> queue;
+    BrandesPass pass;
+    bool verifyAfterUpdate = false;
+    uint64_t updates = 0;
+    uint64_t sourcesRecomputed = 0;
+
+    void accumulateSource(uint32_t source, double sign)
+    {
+        double distanceSum = pass.run(*this, source, [&](uint32_t v, double dependency)
+            {
+                betweenness[v] += sign * dependency;
+                reach[v] += sign;
+            });
+        closeness[source] = sign > 0 && distanceSum > 0 ? (pass.order.size() - 1) / distanceSum : 0.0;
+    }
+
+    // Fills result[s] with d(s, target), or -1 where target is unreachable, by a
+    // BFS over in-edges.
+    void distancesTo(uint32_t target, vector<int32_t>& result)
+    {
+        fill(result.begin(), result.end(), -1);
+        queue.clear();
+        queue.push_back(target);
+        result[target] = 0;
+        for (size_t head = 0; head < queue.size(); ++head)
+        {
+            uint32_t current = queue[head];
+            for (uint32_t predecessor : inAdjacency[current])
+            {
+                if (result[predecessor] < 0)
+                {
+                    result[predecessor] = result[current] + 1;
+                    queue.push_back(predecessor);
+                }
+            }
+        }
+    }
+
+    // Only vertices that reach u can be affected, so the candidates are the
+    // vertices visited by the reverse BFS from u.
+    vector<uint32_t> affectedSources(uint32_t u, uint32_t v, bool insertion)
+    {
+        distancesTo(v, distanceToV);
+        distancesTo(u, distanceToU);
+        vector<uint32_t> affected;
+        for (uint32_t source : queue)
+        {
+            if (!present[source])
+            {
+                continue;
+            }
+            int32_t du = distanceToU[source];
+            int32_t dv = distanceToV[source];
+            if (insertion ? (dv < 0 || du + 1 <= dv) : (du + 1 == dv))
+            {
+                affected.push_back(source);
+            }
+        }
+        return affected;
+    }
+
+    void applyUpdate(uint32_t u, uint32_t v, bool insertion)
+    {
+        vector<uint32_t> affected = affectedSources(u, v, insertion);
+        for (uint32_t source : affected)
+        {
+            accumulateSource(source, -1.0);
+        }
+
+        if (insertion)
+        {
+            outAdjacency[u].push_back(v);
+            inAdjacency[v].push_back(u);
+        }
+        else
+        {
+            outAdjacency[u].erase(find(outAdjacency[u].begin(), outAdjacency[u].end(), v));
+            inAdjacency[v].erase(find(inAdjacency[v].begin(), inAdjacency[v].end(), u));
+        }
+
+        for (uint32_t source : affected)
+        {
+            accumulateSource(source, 1.0);
+        }
+
+        ++updates;
+        sourcesRecomputed += affected.size();
+        if (verifyAfterUpdate)
+        {
+            verify();
+        }
+    }
+
+public:
+    void addVertex(uint32_t id, const string& name)
+    {
+        if (id >= names.size())
+        {
+            size_t vertexCount = id + 1;
+            names.resize(vertexCount);
+            present.resize(vertexCount, false);
+            outAdjacency.resize(vertexCount);
+            inAdjacency.resize(vertexCount);
+            betweenness.resize(vertexCount, 0.0);
+            closeness.resize(vertexCount, 0.0);
+            reach.resize(vertexCount, 0.0);
+            distanceToU.resize(vertexCount, -1);
+            distanceToV.resize(vertexCount, -1);
+            pass.resize(vertexCount);
+        }
+        names[id] = name;
+        present[id] = true;
+    }
+
+    // Callers must delete every incident edge first.
+    void removeVertex(uint32_t id)
+    {
+        present[id] = false;
+        closeness[id] = 0.0;
+    }
+
+    uint32_t getVertexCount() const
+    {
+        return static_cast<uint32_t>(names.size());
+    }
+
+    bool isPresent(uint32_t v) const
+    {
+        return present[v];
+    }
+
+    template <typename Visit>
+    void forEachOutNeighbor(uint32_t v, Visit visit) const
+    {
+        for (uint32_t neighbor : outAdjacency[v])
+        {
+            visit(neighbor);
+        }
+    }
+
+    // Adds an edge without updating centrality; call recomputeAll() after bulk loading.
+    void loadEdge(uint32_t u, uint32_t v)
+    {
+        outAdjacency[u].push_back(v);
+        inAdjacency[v].push_back(u);
+    }
+
+    void insertEdge(uint32_t u, uint32_t v)
+    {
+        applyUpdate(u, v, true);
+    }
+
+    void deleteEdge(uint32_t u, uint32_t v)
+    {
+        if (find(outAdjacency[u].begin(), outAdjacency[u].end(), v) != outAdjacency[u].end())
+        {
+            applyUpdate(u, v, false);
+        }
+    }
+
+    void recomputeAll()
+    {
+        fill(betweenness.begin(), betweenness.end(), 0.0);
+        fill(closeness.begin(), closeness.end(), 0.0);
+        fill(reach.begin(), reach.end(), 0.0);
+        for (uint32_t source = 0; source < names.size(); ++source)
+        {
+            if (present[source])
+            {
+                accumulateSource(source, 1.0);
+            }
+        }
+    }
+
+    // Reruns the full computation and reports every vertex whose incrementally
+    // maintained values disagree with it. The full results are kept afterwards.
+    size_t verify()
+    {
+        vector<double> incrementalBetweenness = betweenness;
+        vector<double> incrementalCloseness = closeness;
+        vector<double> incrementalReach = reach;
+        recomputeAll();
+
+        auto differs = [](double a, double b) { return fabs(a - b) > 1e-6 * max(1.0, fabs(b)); };
+        size_t mismatches = 0;
+        for (uint32_t v = 0; v < names.size(); ++v)
+        {
+            if (present[v] && (differs(incrementalBetweenness[v], betweenness[v])
+                || differs(incrementalCloseness[v], closeness[v]) || differs(incrementalReach[v], reach[v])))
+            {
+                cerr << "Error: Dynamic centrality mismatch for " << names[v] << " (betweenness "
+                    << incrementalBetweenness[v] << " vs " << betweenness[v] << ", closeness "
+                    << incrementalCloseness[v] << " vs " << closeness[v] << ")\n";
+                ++mismatches;
+            }
+        }
+        return mismatches;
+    }
+
+    void setVerifyAfterUpdate(bool enabled)
+    {
+        verifyAfterUpdate = enabled;
+    }
+
+    bool getVerifyAfterUpdate() const
+    {
+        return verifyAfterUpdate;
+    }
+
+    const vector<double>& getBetweenness() const
+    {
+        return betweenness;
+    }
+
+    const vector<double>& getCloseness() const
+    {
+        return closeness;
+    }
+
+    const vector<double>& getReach() const
+    {
+        return reach;
+    }
+
+    uint64_t getUpdateCount() const
+    {
+        return updates;
+    }
+
+    uint64_t getSourcesRecomputed() const
+    {
+        return sourcesRecomputed;
+    }
+};
+
+struct TemporalEdge {
+    Timestamp validFrom;
+    Timestamp validUntil;
+    uint32_t source;
+    uint32_t target;
+    double weight;
+    uint8_t type;
+    bool removed;
+
+    bool overlaps(Timestamp start, Timestamp end) const
+    {
+        return !removed && validFrom < end && validUntil > start;
+    }
+};
+
+// Every relationship with a validity interval. Relationships valid at all times
+// are not logged; windows read them from the adjacency lists and only need to know
+// when they change. Entries keep their insertion index; byStart and byEnd order
+// them by start and end time, and each individual's outgoing edges are kept in
+// start-time order. Added entries are merged into the indexes in one sort per
+// index the next time the log is read, so a bulk load sorts once.
+class TemporalEdgeLog {
+
+private:
+    vector<TemporalEdge> entries;
+    size_t indexedEntries = 0;
+    vector<uint32_t> byStart;
+    vector<uint32_t> byEnd;
+    vector<vector<uint32_t>> outgoing;
+    vector<vector<uint32_t>> incoming;
+    uint64_t version = 0;
+    uint64_t permanentVersion = 0;
+
+    // Orders the entries appended to index after oldSize and merges them into the
+    // sorted prefix, keeping insertion order among equal keys.
+    template <typename Key>
+    void mergeAppended(vector<uint32_t>& index, size_t oldSize, Key key)
+    {
+        auto less = [&key](uint32_t a, uint32_t b) { return key(a) < key(b); };
+        stable_sort(index.begin() + oldSize, index.end(), less);
+        inplace_merge(index.begin(), index.begin() + oldSize, index.end(), less);
+    }
+
+    void markRemoved(uint32_t entry)
+    {
+        if (!entries[entry].removed)
+        {
+            entries[entry].removed = true;
+            ++version;
+        }
+    }
+
+public:
+    void add(uint32_t source, uint32_t target, double weight, RelationshipType type, Timestamp validFrom, Timestamp validUntil)
+    {
+        entries.push_back({ validFrom, validUntil, source, target, weight, static_cast<uint8_t>(type), false });
+    }
+
+    void addMany(const vector<TemporalEdge>& added)
+    {
+        entries.reserve(entries.size() + added.size());
+        for (const TemporalEdge& edge : added)
+        {
+            entries.push_back(edge);
+            entries.back().removed = false;
+        }
+    }
+
+    // Merges the entries added since the last call into the indexes.
+    void settle()
+    {
+        if (indexedEntries == entries.size())
+        {
+            return;
+        }
+        uint32_t first = static_cast<uint32_t>(indexedEntries);
+        uint32_t maxVertex = 0;
+        for (uint32_t entry = first; entry < entries.size(); ++entry)
+        {
+            maxVertex = max(maxVertex, max(entries[entry].source, entries[entry].target));
+        }
+        if (outgoing.size() <= maxVertex)
+        {
+            outgoing.resize(maxVertex + 1);
+            incoming.resize(maxVertex + 1);
+        }
+
+        auto start = [this](uint32_t e) { return entries[e].validFrom; };
+        size_t indexSize = byStart.size();
+        for (uint32_t entry = first; entry < entries.size(); ++entry)
+        {
+            byStart.push_back(entry);
+            byEnd.push_back(entry);
+        }
+        mergeAppended(byStart, indexSize, start);
+        mergeAppended(byEnd, indexSize, [this](uint32_t e) { return entries[e].validUntil; });
+
+        vector<pair<vector<uint32_t>*, size_t>> touched;
+        for (uint32_t entry = first; entry < entries.size(); ++entry)
+        {
+            for (vector<uint32_t>* list : { &outgoing[entries[entry].source], &incoming[entries[entry].target] })
+            {
+                if (list->empty() || list->back() < first)
+                {
+                    touched.push_back({ list, list->size() });
+                }
+                list->push_back(entry);
+            }
+        }
+        for (const auto& list : touched)
+        {
+            mergeAppended(*list.first, list.second, start);
+        }
+        indexedEntries = entries.size();
+    }
+
+    // Records that a relationship valid at all times was added.
+    void addPermanent()
+    {
+        ++permanentVersion;
+    }
+
+    // Removing relationships may also remove ones valid at all times, so both
+    // versions change.
+    void removeEdges(uint32_t source, uint32_t target)
+    {
+        settle();
+        ++permanentVersion;
+        if (source >= outgoing.size())
+        {
+            return;
+        }
+        for (uint32_t entry : outgoing[source])
+        {
+            if (entries[entry].target == target)
+            {
+                markRemoved(entry);
+            }
+        }
+    }
+
+    void removeVertex(uint32_t v)
+    {
+        settle();
+        ++permanentVersion;
+        if (v >= outgoing.size())
+        {
+            return;
+        }
+        for (uint32_t entry : outgoing[v])
+        {
+            markRemoved(entry);
+        }
+        for (uint32_t entry : incoming[v])
+        {
+            markRemoved(entry);
+        }
+    }
+
+    void clear()
+    {
+        entries.clear();
+        indexedEntries = 0;
+        byStart.clear();
+        byEnd.clear();
+        outgoing.clear();
+        incoming.clear();
+        ++version;
+        ++permanentVersion;
+    }
+
+    // Changes whenever an existing entry is removed; appends leave it untouched.
+    uint64_t getVersion() const
+    {
+        return version;
+    }
+
+    // Changes whenever a relationship valid at all times may have been added or removed.
+    uint64_t getPermanentVersion() const
+    {
+        return permanentVersion;
+    }
+
+    // The indexes below cover the first size() entries after settle().
+    size_t size() const
+    {
+        return entries.size();
+    }
+
+    const TemporalEdge& get(uint32_t entry) const
+    {
+        return entries[entry];
+    }
+
+    const vector<uint32_t>& getByStart() const
+    {
+        return byStart;
+    }
+
+    const vector<uint32_t>& getByEnd() const
+    {
+        return byEnd;
+    }
+
+    const vector<uint32_t>& getOutgoing(uint32_t v) const
+    {
+        static const vector<uint32_t> none;
+        return v < outgoing.size() ? outgoing[v] : none;
+    }
+};
+
+// Degree, reachability and communities over the relationships valid somewhere in
+// [start, end). Relationships valid at all times come from the adjacency lists and
+// are counted once per change to them; the ones with an interval come from the log.
+// Sliding the window forward only visits the edges that enter or leave it. Moving
+// it backwards, or removing relationships, rebuilds the state from the log entries
+// that start before the window ends. Communities and reachability are kept up to
+// date while edges only enter, and are recomputed on the next query after an edge
+// leaves. Writer thread only.
+class SlidingWindow {
+
+private:
+    TemporalEdgeLog* log;
+    const vector<vector<Edge*>>* adjacency;
+    Timestamp windowStart = TIME_MIN;
+    Timestamp windowEnd = TIME_MAX;
+    size_t seenEntries = 0;
+    uint64_t seenVersion = numeric_limits<uint64_t>::max();
+    uint64_t seenPermanentVersion = numeric_limits<uint64_t>::max();
+    size_t permanentEdges = 0;
+    vector<uint32_t> permanentDegree;
+    vector<uint32_t> permanentCommunity;
+    size_t activeEdges = 0;
+    vector<uint32_t> degree;
+    vector<uint32_t> communityParent;
+    bool communitiesValid = false;
+    uint32_t reachSource = NO_COMPONENT;
+    vector<char> reached;
+    bool reachValid = false;
+    uint64_t edgesEntered = 0;
+    uint64_t edgesLeft = 0;
+    uint64_t rebuilds = 0;
+
+    static uint32_t findCommunity(vector<uint32_t>& parent, uint32_t v)
+    {
+        while (parent[v] != v)
+        {
+            parent[v] = parent[parent[v]];
+            v = parent[v];
+        }
+        return v;
+    }
+
+    static void unite(vector<uint32_t>& parent, uint32_t a, uint32_t b)
+    {
+        a = findCommunity(parent, a);
+        b = findCommunity(parent, b);
+        if (a != b)
+        {
+            parent[max(a, b)] = min(a, b);
+        }
+    }
+
+    uint32_t getVertexCount() const
+    {
+        return static_cast<uint32_t>(adjacency->size());
+    }
+
+    template <typename Visitor>
+    void forEachPermanentNeighbor(uint32_t v, Visitor&& visit) const
+    {
+        for (const Edge* edge : (*adjacency)[v])
+        {
+            if (!edge->isTemporal())
+            {
+                visit(edge->getDestination()->getId());
+            }
+        }
+    }
+
+    // Recounts degrees and communities over the relationships valid at all times
+    // when they changed, and extends them to new individuals otherwise.
+    void syncPermanent()
+    {
+        uint32_t vertexCount = getVertexCount();
+        if (seenPermanentVersion == log->getPermanentVersion())
+        {
+            permanentDegree.resize(vertexCount, 0);
+            for (uint32_t v = static_cast<uint32_t>(permanentCommunity.size()); v < vertexCount; ++v)
+            {
+                permanentCommunity.push_back(v);
+            }
+            return;
+        }
+
+        permanentEdges = 0;
+        permanentDegree.assign(vertexCount, 0);
+        permanentCommunity.resize(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            permanentCommunity[v] = v;
+        }
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            forEachPermanentNeighbor(v, [this, v](uint32_t target)
+            {
+                ++permanentEdges;
+                ++permanentDegree[v];
+                ++permanentDegree[target];
+                unite(permanentCommunity, v, target);
+            });
+        }
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            permanentCommunity[v] = findCommunity(permanentCommunity, v);
+        }
+        seenPermanentVersion = log->getPermanentVersion();
+    }
+
+    // Calls visit for every log entry valid in the window, scanning the entries
+    // that start before the window ends.
+    template <typename Visitor>
+    void forEachActiveEntry(Visitor&& visit) const
+    {
+        for (uint32_t entry : log->getByStart())
+        {
+            const TemporalEdge& edge = log->get(entry);
+            if (edge.validFrom >= windowEnd)
+            {
+                break;
+            }
+            if (edge.overlaps(windowStart, windowEnd))
+            {
+                visit(edge);
+            }
+        }
+    }
+
+    // Marks everything reachable from v over edges valid in the window.
+    void extendReach(uint32_t v)
+    {
+        vector<uint32_t> stack = { v };
+        auto visit = [this, &stack](uint32_t target)
+        {
+            if (!reached[target])
+            {
+                reached[target] = 1;
+                stack.push_back(target);
+            }
+        };
+        while (!stack.empty())
+        {
+            uint32_t current = stack.back();
+            stack.pop_back();
+            forEachPermanentNeighbor(current, visit);
+            for (uint32_t entry : log->getOutgoing(current))
+            {
+                const TemporalEdge& edge = log->get(entry);
+                if (edge.validFrom >= windowEnd)
+                {
+                    break;
+                }
+                if (edge.overlaps(windowStart, windowEnd))
+                {
+                    visit(edge.target);
+                }
+            }
+        }
+    }
+
+    void enter(uint32_t entry)
+    {
+        const TemporalEdge& edge = log->get(entry);
+        ++activeEdges;
+        ++degree[edge.source];
+        ++degree[edge.target];
+        if (communitiesValid)
+        {
+            unite(communityParent, edge.source, edge.target);
+        }
+        if (reachValid && reached[edge.source] && !reached[edge.target])
+        {
+            reached[edge.target] = 1;
+            extendReach(edge.target);
+        }
+        ++edgesEntered;
+    }
+
+    void leave(uint32_t entry)
+    {
+        const TemporalEdge& edge = log->get(entry);
+        --activeEdges;
+        --degree[edge.source];
+        --degree[edge.target];
+        communitiesValid = false;
+        reachValid = false;
+        ++edgesLeft;
+    }
+
+    void rebuild()
+    {
+        log->settle();
+        syncPermanent();
+        degree = permanentDegree;
+        activeEdges = permanentEdges;
+        forEachActiveEntry([this](const TemporalEdge& edge)
+        {
+            ++activeEdges;
+            ++degree[edge.source];
+            ++degree[edge.target];
+        });
+        communitiesValid = false;
+        reachValid = false;
+        seenEntries = log->size();
+        seenVersion = log->getVersion();
+        ++rebuilds;
+    }
+
+    // Picks up relationships added to or removed from the graph since the last call.
+    void sync()
+    {
+        log->settle();
+        uint32_t vertexCount = getVertexCount();
+        if (seenVersion != log->getVersion() || seenPermanentVersion != log->getPermanentVersion()
+            || degree.size() > vertexCount)
+        {
+            rebuild();
+            return;
+        }
+        if (degree.size() < vertexCount)
+        {
+            syncPermanent();
+            degree.resize(vertexCount, 0);
+            if (communitiesValid)
+            {
+                for (uint32_t v = static_cast<uint32_t>(communityParent.size()); v < vertexCount; ++v)
+                {
+                    communityParent.push_back(v);
+                }
+            }
+            if (reachValid)
+            {
+                reached.resize(vertexCount, 0);
+            }
+        }
+        for (; seenEntries < log->size(); ++seenEntries)
+        {
+            if (log->get(static_cast<uint32_t>(seenEntries)).overlaps(windowStart, windowEnd))
+            {
+                enter(static_cast<uint32_t>(seenEntries));
+            }
+        }
+    }
+
+public:
+    SlidingWindow(TemporalEdgeLog& l, const vector<vector<Edge*>>& outgoingEdges)
+        : log(&l), adjacency(&outgoingEdges) {}
+
+    void setWindow(Timestamp start, Timestamp end)
+    {
+        sync();
+        if (start < windowStart || end < windowEnd)
+        {
+            windowStart = start;
+            windowEnd = end;
+            rebuild();
+            return;
+        }
+
+        const vector<uint32_t>& byEnd = log->getByEnd();
+        auto leaving = upper_bound(byEnd.begin(), byEnd.end(), windowStart,
+            [this](Timestamp time, uint32_t e) { return time < log->get(e).validUntil; });
+        for (; leaving != byEnd.end() && log->get(*leaving).validUntil <= start; ++leaving)
+        {
+            if (log->get(*leaving).overlaps(windowStart, windowEnd))
+            {
+                leave(*leaving);
+            }
+        }
+
+        Timestamp previousEnd = windowEnd;
+        windowStart = start;
+        windowEnd = end;
+
+        const vector<uint32_t>& byStart = log->getByStart();
+        auto entering = lower_bound(byStart.begin(), byStart.end(), previousEnd,
+            [this](uint32_t e, Timestamp time) { return log->get(e).validFrom < time; });
+        for (; entering != byStart.end() && log->get(*entering).validFrom < end; ++entering)
+        {
+            if (log->get(*entering).overlaps(windowStart, windowEnd))
+            {
+                enter(*entering);
+            }
+        }
+    }
+
+    Timestamp getStart() const
+    {
+        return windowStart;
+    }
+
+    Timestamp getEnd() const
+    {
+        return windowEnd;
+    }
+
+    size_t getActiveEdgeCount()
+    {
+        sync();
+        return activeEdges;
+    }
+
+    const vector<uint32_t>& getDegrees()
+    {
+        sync();
+        return degree;
+    }
+
+    // Community representative of every individual over the window's relationships.
+    vector<uint32_t> getCommunities()
+    {
+        sync();
+        uint32_t vertexCount = static_cast<uint32_t>(degree.size());
+        if (!communitiesValid)
+        {
+            communityParent = permanentCommunity;
+            forEachActiveEntry([this](const TemporalEdge& edge) { unite(communityParent, edge.source, edge.target); });
+            communitiesValid = true;
+        }
+
+        vector<uint32_t> communities(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            communities[v] = findCommunity(communityParent, v);
+        }
+        return communities;
+    }
+
+    // Individuals reachable from source over relationships valid in the window,
+    // ignoring the order in which they were valid.
+    const vector<char>& getReach(uint32_t source)
+    {
+        sync();
+        if (!reachValid || reachSource != source)
+        {
+            reached.assign(degree.size(), 0);
+            if (source < reached.size())
+            {
+                reached[source] = 1;
+                extendReach(source);
+            }
+            reachSource = source;
+            reachValid = true;
+        }
+        return reached;
+    }
+
+    // Earliest arrival over time-respecting paths that start at the window start:
+    // an edge can be taken at any moment of its interval that is not earlier than
+    // the arrival at its source. Unreachable individuals get TIME_MAX.
+    vector<Timestamp> getEarliestArrival(uint32_t source, vector<uint32_t>& predecessor)
+    {
+        sync();
+        uint32_t vertexCount = static_cast<uint32_t>(degree.size());
+        vector<Timestamp> arrival(vertexCount, TIME_MAX);
+        predecessor.assign(vertexCount, NO_COMPONENT);
+        if (source >= vertexCount)
+        {
+            return arrival;
+        }
+
+        priority_queue<pair<Timestamp, uint32_t>, vector<pair<Timestamp, uint32_t>>, greater<>> pq;
+        arrival[source] = windowStart;
+        pq.push({ windowStart, source });
+        while (!pq.empty())
+        {
+            Timestamp time = pq.top().first;
+            uint32_t current = pq.top().second;
+            pq.pop();
+            if (time != arrival[current])
+            {
+                continue;
+            }
+
+            auto relax = [&](uint32_t target, Timestamp departure)
+            {
+                if (departure < arrival[target])
+                {
+                    arrival[target] = departure;
+                    predecessor[target] = current;
+                    pq.push({ departure, target });
+                }
+            };
+            if (time < windowEnd)
+            {
+                forEachPermanentNeighbor(current, [&relax, time](uint32_t target) { relax(target, time); });
+            }
+            for (uint32_t entry : log->getOutgoing(current))
+            {
+                const TemporalEdge& edge = log->get(entry);
+                if (edge.validFrom >= windowEnd)
+                {
+                    break;
+                }
+                Timestamp departure = max(time, edge.validFrom);
+                if (edge.removed || departure >= edge.validUntil || departure >= windowEnd)
+                {
+                    continue;
+                }
+                relax(edge.target, departure);
+            }
+        }
+        return arrival;
+    }
+
+    void displayStatistics() const
+    {
+        cout << "Window updates: " << edgesEntered << " relationships entered, " << edgesLeft
+            << " left, " << rebuilds << " full rebuilds\n";
+    }
+};
+
+// Machine-readable copy of what an analysis report prints: named lists of scored
+// individuals, of individuals and of groups, and named values.
+struct ReportData {
+    vector<pair<string, vector<pair<string, double>>>> rankings;
+    vector<pair<string, vector<string>>> lists;
+    vector<pair<string, vector<vector<string>>>> groupings;
+    vector<pair<string, double>> values;
+};
+
+class SocialNetwork {
+
+private:
+    NodeAttributeStore attributes;
+    deque<Node> nodes;
+    vector<Edge*> edges;
+    vector<Event*> events;
+    unordered_map<string, vector<string>> attendance;
+    MutationLog* mutationLog = nullptr;
+    thread compactionThread;
+    size_t compactionThreshold = 4096;
+    unordered_map<string, uint32_t> nodeIds;
+    uint32_t nextNodeId = 0;
+    uint64_t modificationCounter = 0;
+    bool rebuildAllSegments = true;
+    unordered_set<uint32_t> dirtySegments;
+    unordered_set<uint32_t> dirtyVertexChunks;
+    unordered_map<uint32_t, vector<pair<string, uint32_t>>> pendingIdChanges;
+    vector<vector<Edge*>> outgoingEdges;
+    vector<vector<Edge*>> incomingEdges;
+    EpochManager epochs;
+    atomic<const GraphSnapshot*> publishedSnapshot{ nullptr };
+    AnalysisCache analysisCache;
+    DynamicCentrality* dynamicCentrality = nullptr;
+    atomic<bool> useCompressedAdjacency{ false };
+    TemporalEdgeLog temporalEdges;
+    SlidingWindow timeWindow{ temporalEdges, outgoingEdges };
+    BackgroundJobs backgroundJobs;
+    PathQueryEngine pathQueries;
+    DistanceOracle distanceOracle;
+    shared_ptr<const LandmarkIndex> landmarkIndex;
+    uint32_t landmarkCount = 0;
+    thread landmarkThread;
+    atomic<bool> landmarkBuildRunning{ false };
+
+    // Returns nullptr, after reporting why, when the graph has too many vertices to compress.
+    shared_ptr<const CompressedGraph> getCompressedGraph(const GraphSnapshot& graph)
+    {
+        if (!CompressedGraph::fits(graph))
+        {
+            cerr << "Error: Too many vertices for compressed adjacency (limit " << CompressedGraph::MAX_VERTICES << ").\n";
+            return nullptr;
+        }
+        return analysisCache.getOrCompute<CompressedGraph>("compressed-adjacency", "", graph.getVersion(),
+            [&graph]() { return CompressedGraph(graph); });
+    }
+
+    // Runs compute on the directed, unweighted adjacency of graph: the compressed
+    // form when it is enabled and the graph fits, otherwise the flat CSR view. The
+    // two are never cached together.
+    template <typename Compute>
+    auto withDirectedAdjacency(const GraphSnapshot& graph, Compute&& compute)
+    {
+        if (useCompressedAdjacency)
+        {
+            if (auto compressed = getCompressedGraph(graph))
+            {
+                analysisCache.erase("typed-graph", reachGraphLayout());
+                return compute(*compressed);
+            }
+        }
+        return compute(*getTypedGraph<Unweighted, Directed>(graph));
+    }
+
+    template <typename Weight, typename Direction>
+    static string typedGraphLayout()
+    {
+        return string(WeightPolicy<Weight>::name()) + "/" + Direction::name();
+    }
+
+    static string reachGraphLayout()
+    {
+        return typedGraphLayout<Unweighted, Directed>();
+    }
+
+    template <typename Weight, typename Direction>
+    shared_ptr<const TypedGraph<Weight, Direction>> getTypedGraph(const GraphSnapshot& graph)
+    {
+        string layout = typedGraphLayout<Weight, Direction>();
+        return analysisCache.getOrCompute<TypedGraph<Weight, Direction>>("typed-graph", layout, graph.getVersion(),
+            [&graph]() { return TypedGraph<Weight, Direction>(graph); });
+    }
+
+    // Times one specialization: building it, hop BFS from every source, and one
+    // pass summing the weights of all edges.
+    template <typename Weight, typename Direction>
+    static void benchmarkSpecialization(const GraphSnapshot& graph, const vector<uint32_t>& sources)
+    {
+        auto start = chrono::steady_clock::now();
+        TypedGraph<Weight, Direction> typed(graph);
+        auto built = chrono::steady_clock::now();
+
+        uint64_t reached = 0;
+        vector<uint32_t> visitedBy(typed.getVertexCount(), numeric_limits<uint32_t>::max());
+        vector<uint32_t> bfsQueue;
+        for (uint32_t source : sources)
+        {
+            bfsQueue.assign(1, source);
+            visitedBy[source] = source;
+            for (size_t head = 0; head < bfsQueue.size(); ++head)
+            {
+                typed.forEachOutNeighbor(bfsQueue[head], [&](uint32_t neighbor)
+                    {
+                        if (visitedBy[neighbor] != source)
+                        {
+                            visitedBy[neighbor] = source;
+                            bfsQueue.push_back(neighbor);
+                        }
+                    });
+            }
+            reached += bfsQueue.size();
+        }
+        auto searched = chrono::steady_clock::now();
+
+        double totalWeight = 0.0;
+        for (uint32_t v = 0; v < typed.getVertexCount(); ++v)
+        {
+            typed.forEachOutEdge(v, [&totalWeight](uint32_t, double weight) { totalWeight += weight; });
+        }
+        auto summed = chrono::steady_clock::now();
+
+        auto ms = [](chrono::steady_clock::duration d) { return chrono::duration<double, milli>(d).count(); };
+        streamsize precision = cout.precision();
+        cout << left << setw(12) << WeightPolicy<Weight>::name() << setw(12) << Direction::name() << right
+            << setw(12) << typed.getMemoryBytes() << setw(11) << fixed << setprecision(2) << ms(built - start)
+            << setw(11) << ms(searched - built) << setw(11) << ms(summed - searched)
+            << "   reached " << reached << ", weight " << totalWeight << "\n" << defaultfloat << setprecision(precision);
+    }
+
+    void markModified(uint32_t id)
+    {
+        dirtySegments.insert(id / SNAPSHOT_SEGMENT_SIZE);
+        ++modificationCounter;
+    }
+
+    // Records that the name, role or presence of id changed for the next vertex table.
+    void markVertexChanged(uint32_t id, const string& name, bool present)
+    {
+        dirtyVertexChunks.insert(id / SNAPSHOT_SEGMENT_SIZE);
+        pendingIdChanges[VertexTable::shardOf(name)].push_back({ name, present ? id : numeric_limits<uint32_t>::max() });
+    }
+
+    void linkEdge(Edge* edge)
+    {
+        outgoingEdges[edge->getSource()->getId()].push_back(edge);
+        incomingEdges[edge->getDestination()->getId()].push_back(edge);
+    }
+
+    // Drops the relationships matching remove from the incidence lists of the given
+    // vertices; must run before those relationships are deleted.
+    template <typename Predicate>
+    void unlinkEdges(const unordered_set<uint32_t>& vertices, Predicate remove)
+    {
+        for (uint32_t v : vertices)
+        {
+            for (vector<Edge*>* list : { &outgoingEdges[v], &incomingEdges[v] })
+            {
+                list->erase(remove_if(list->begin(), list->end(), remove), list->end());
+            }
+        }
+    }
+
+    // Copies only the chunks and id shards touched since current was published;
+    // everything else is shared with current.
+    shared_ptr<const VertexTable> buildVertexTable(const GraphSnapshot* current) const
+    {
+        const VertexTable* previous = (current == nullptr || rebuildAllSegments) ? nullptr : current->getVertexTable().get();
+        if (previous != nullptr && dirtyVertexChunks.empty() && pendingIdChanges.empty() && previous->vertexCount == nextNodeId)
+        {
+            return current->getVertexTable();
+        }
+
+        auto table = make_shared<VertexTable>();
+        table->vertexCount = nextNodeId;
+        for (uint32_t roleId : attributes.getRoleNames())
+        {
+            table->roleNames.push_back(attributes.getDictionary().get(roleId));
+        }
+
+        uint32_t chunkCount = (nextNodeId + SNAPSHOT_SEGMENT_SIZE - 1) / SNAPSHOT_SEGMENT_SIZE;
+        table->chunks.resize(chunkCount);
+        for (uint32_t i = 0; i < chunkCount; ++i)
+        {
+            uint32_t first = i * SNAPSHOT_SEGMENT_SIZE;
+            uint32_t count = min(SNAPSHOT_SEGMENT_SIZE, nextNodeId - first);
+            if (previous != nullptr && i < previous->chunks.size() && previous->chunks[i]->names.size() == count
+                && dirtyVertexChunks.find(i) == dirtyVertexChunks.end())
+            {
+                table->chunks[i] = previous->chunks[i];
+                continue;
+            }
+            auto chunk = make_shared<VertexChunk>();
+            chunk->names.resize(count);
+            chunk->roleCodes.resize(count);
+            chunk->present.resize(count);
+            for (uint32_t local = 0; local < count; ++local)
+            {
+                chunk->names[local] = attributes.getName(first + local);
+                chunk->roleCodes[local] = attributes.getRoleCode(first + local);
+                chunk->present[local] = chunk->roleCodes[local] != NO_ROLE;
+            }
+            table->chunks[i] = chunk;
+        }
+
+        table->idShards.resize(VertexTable::ID_SHARDS);
+        if (previous == nullptr)
+        {
+            vector<unordered_map<string, uint32_t>> shards(VertexTable::ID_SHARDS);
+            for (const auto& idPair : nodeIds)
+            {
+                shards[VertexTable::shardOf(idPair.first)].insert(idPair);
+            }
+            for (uint32_t shard = 0; shard < VertexTable::ID_SHARDS; ++shard)
+            {
+                table->idShards[shard] = make_shared<unordered_map<string, uint32_t>>(move(shards[shard]));
+            }
+            return table;
+        }
+        for (uint32_t shard = 0; shard < VertexTable::ID_SHARDS; ++shard)
+        {
+            auto changes = pendingIdChanges.find(shard);
+            if (changes == pendingIdChanges.end())
+            {
+                table->idShards[shard] = previous->idShards[shard];
+                continue;
+            }
+            auto ids = make_shared<unordered_map<string, uint32_t>>(*previous->idShards[shard]);
+            for (const auto& change : changes->second)
+            {
+                if (change.second == numeric_limits<uint32_t>::max())
+                {
+                    ids->erase(change.first);
+                }
+                else
+                {
+                    (*ids)[change.first] = change.second;
+                }
+            }
+            table->idShards[shard] = ids;
+        }
+        return table;
+    }
+
+    struct SegmentEntry {
+        uint32_t local;
+        uint32_t other;
+        double weight;
+        uint8_t type;
+
+        bool operator<(const SegmentEntry& e) const
+        {
+            return local != e.local ? local < e.local : other < e.other;
+        }
+    };
+
+    static void fillCsr(vector<SegmentEntry>& entries, uint32_t vertexCount, vector<uint32_t>& offsets,
+        vector<uint32_t>& others, vector<double>& weights, vector<uint8_t>& types)
+    {
+        sort(entries.begin(), entries.end());
+        offsets.assign(vertexCount + 1, 0);
+        others.reserve(entries.size());
+        weights.reserve(entries.size());
+        types.reserve(entries.size());
+        for (const auto& entry : entries)
+        {
+            ++offsets[entry.local + 1];
+            others.push_back(entry.other);
+            weights.push_back(entry.weight);
+            types.push_back(entry.type);
+        }
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            offsets[v + 1] += offsets[v];
+        }
+    }
+
+    void logMutation(MutationType type, const vector<string>& strings, double weight = 0.0, int relationshipType = 0)
+    {
+        if (mutationLog != nullptr)
+        {
+            mutationLog->append(type, strings, weight, relationshipType);
+        }
+    }
+
+    void logMutations(const vector<MutationRecord>& records)
+    {
+        if (mutationLog != nullptr && !records.empty())
+        {
+            mutationLog->appendRecords(records);
+        }
+    }
+
+    static bool parseTimestamp(const string& text, Timestamp& value)
+    {
+        char* end = nullptr;
+        errno = 0;
+        long long parsed = strtoll(text.c_str(), &end, 10);
+        if (end == text.c_str() || *end != '\0' || errno == ERANGE)
+        {
+            return false;
+        }
+        value = parsed;
+        return true;
+    }
+
+    // The log record that recreates edge.
+    static MutationRecord edgeRecord(const Edge& edge)
+    {
+        MutationRecord record;
+        record.strings = { edge.getSource()->getName(), edge.getDestination()->getName() };
+        record.weight = edge.getWeight();
+        record.relationshipType = static_cast<int>(edge.getRelationshipType());
+        record.type = MUTATION_ADD_EDGE;
+        if (edge.isTemporal())
+        {
+            record.type = MUTATION_ADD_TEMPORAL_EDGE;
+            record.strings.push_back(to_string(edge.getValidFrom()));
+            record.strings.push_back(to_string(edge.getValidUntil()));
+        }
+        return record;
+    }
+
+    // Adds or updates an individual without logging it.
+    bool insertNode(const string& name, const string& role, const vector<string>& interests)
+    {
+        auto idIt = nodeIds.find(name);
+        uint32_t id = idIt == nodeIds.end() ? nextNodeId : idIt->second;
+        if (!attributes.set(id, name, role, interests))
+        {
+            cerr << "Error: Too many distinct roles.\n";
+            return false;
+        }
+        if (idIt == nodeIds.end())
+        {
+            nodes.emplace_back(&attributes, id);
+            outgoingEdges.emplace_back();
+            incomingEdges.emplace_back();
+            nodeIds[name] = nextNodeId++;
+            if (dynamicCentrality != nullptr)
+            {
+                dynamicCentrality->addVertex(id, name);
+            }
+        }
+        markVertexChanged(id, name, true);
+        markModified(id);
+        return true;
+    }
+
+    // Adds a relationship to the graph without recording it in the temporal or
+    // mutation log. Returns nullptr when it cannot be added.
+    Edge* insertEdge(const string& source, const string& destination, double weight, RelationshipType relationshipType,
+        Timestamp validFrom, Timestamp validUntil)
+    {
+        auto sourceIt = nodeIds.find(source);
+        auto destinationIt = nodeIds.find(destination);
+        if (sourceIt == nodeIds.end() || destinationIt == nodeIds.end())
+        {
+            cout << "Error: Nodes not found while adding edge.\n";
+            return nullptr;
+        }
+        if (validFrom >= validUntil)
+        {
+            cout << "Error: Relationship must start before it ends.\n";
+            return nullptr;
+        }
+        uint32_t sourceId = sourceIt->second;
+        uint32_t destinationId = destinationIt->second;
+        Edge* edge = new Edge(&nodes[sourceId], &nodes[destinationId], weight, relationshipType, validFrom, validUntil);
+        edges.push_back(edge);
+        linkEdge(edge);
+        markModified(sourceId);
+        markModified(destinationId);
+        if (dynamicCentrality != nullptr)
+        {
+            dynamicCentrality->insertEdge(sourceId, destinationId);
+        }
+        return edge;
+    }
+
+    // Returns false when the record is malformed or the mutation fails.
+    bool applyMutation(const MutationRecord& record)
+    {
+        const vector<string>& s = record.strings;
+        switch (record.type)
+        {
+        case MUTATION_ADD_NODE:
+            return !s.empty()
+                && addNode(s[0], s.size() > 1 ? s[1] : "", vector<string>(s.begin() + min<size_t>(2, s.size()), s.end()));
+        case MUTATION_ADD_EDGE:
+            return s.size() == 2 && addEdge(s[0], s[1], record.weight, static_cast<RelationshipType>(record.relationshipType));
+        case MUTATION_REMOVE_NODE:
+            return s.size() == 1 && removeNode(s[0]);
+        case MUTATION_REMOVE_EDGE:
+            return s.size() == 2 && removeEdge(s[0], s[1]);
+        case MUTATION_ADD_EVENT:
+            return s.size() == 2 && addEvent(s[0], s[1]);
+        case MUTATION_REMOVE_EVENT:
+            return s.size() == 1 && removeEvent(s[0]);
+        case MUTATION_MARK_ATTENDANCE:
+            return s.size() == 2 && markAttendance(s[0], s[1]);
+        case MUTATION_ADD_TEMPORAL_EDGE:
+        {
+            Timestamp validFrom, validUntil;
+            return s.size() == 4 && parseTimestamp(s[2], validFrom) && parseTimestamp(s[3], validUntil)
+                && addEdge(s[0], s[1], record.weight, static_cast<RelationshipType>(record.relationshipType), validFrom, validUntil);
+        }
+        }
+        return false;
+    }
+
+    void clear()
+    {
+        for (auto& edge : edges) {
+            delete edge;
+        }
+        for (auto& event : events) {
+            delete event;
+        }
+        nodes.clear();
+        attributes.clear();
+        temporalEdges.clear();
+        edges.clear();
+        events.clear();
+        attendance.clear();
+        nodeIds.clear();
+        outgoingEdges.clear();
+        incomingEdges.clear();
+        nextNodeId = 0;
+        if (dynamicCentrality != nullptr)
+        {
+            delete dynamicCentrality;
+            dynamicCentrality = new DynamicCentrality();
+        }
+        dirtyVertexChunks.clear();
+        pendingIdChanges.clear();
+        rebuildAllSegments = true;
+        ++modificationCounter;
+    }
+
+    // Folds every sealed segment up to and including sealedSequence into a new snapshot.
+    // Runs on its own SocialNetwork instance so the live graph is never touched.
+    static void compactSegments(const string& basePath, uint64_t sealedSequence)
+    {
+        SocialNetwork folded;
+        vector<uint64_t> snapshots = MutationLog::listSequences(basePath, ".snapshot.");
+        uint64_t baseSequence = 0;
+        bool hasSnapshot = false;
+
+        for (auto it = snapshots.rbegin(); it != snapshots.rend(); ++it)
+        {
+            if (*it <= sealedSequence)
+            {
+                baseSequence = *it;
+                hasSnapshot = true;
+                folded.loadGraphDetailsFromFile(MutationLog::snapshotPath(basePath, baseSequence));
+                break;
+            }
+        }
+
+        vector<uint64_t> segments = MutationLog::listSequences(basePath, ".wal.");
+        for (uint64_t sequence : segments)
+        {
+            if ((!hasSnapshot || sequence > baseSequence) && sequence <= sealedSequence)
+            {
+                folded.applyMutations(MutationLog::readSegment(MutationLog::segmentPath(basePath, sequence)));
+            }
+        }
+
+        string target = MutationLog::snapshotPath(basePath, sealedSequence);
+        string temporary = target + ".tmp";
+        if (!folded.writeGraphDetails(temporary) || !MutationLog::syncFile(temporary))
+        {
+            cerr << "Error: Compaction could not write snapshot " << temporary << endl;
+            return;
+        }
+
+        // The segments are only removed once the snapshot and its name are on disk.
+        error_code ec;
+        filesystem::rename(temporary, target, ec);
+        if (ec || !MutationLog::syncDirectory(target))
+        {
+            cerr << "Error: Compaction could not install snapshot " << target << endl;
+            return;
+        }
+
+        for (uint64_t sequence : snapshots)
+        {
+            if (sequence < sealedSequence)
+            {
+                filesystem::remove(MutationLog::snapshotPath(basePath, sequence), ec);
+            }
+        }
+        for (uint64_t sequence : segments)
+        {
+            if (sequence <= sealedSequence)
+            {
+                filesystem::remove(MutationLog::segmentPath(basePath, sequence), ec);
+            }
+        }
+    }
+
+    bool writeGraphDetails(const string& filename)
+    {
+        ofstream outFile(filename);
+
+        if (!outFile.is_open())
+        {
+            return false;
+        }
+
+        outFile << setprecision(numeric_limits<double>::max_digits10);
+        outFile << "Nodes:\n";
+        for (const auto& idPair : nodeIds)
+        {
+            const Node* currentNode = &nodes[idPair.second];
+            outFile << escapeField(currentNode->getName()) << "," << escapeField(currentNode->getRole()) << ",";
+            const auto& interests = currentNode->getInterests();
+            for (size_t i = 0; i < interests.size(); ++i)
+            {
+                outFile << escapeField(interests[i]);
+                if (i != interests.size() - 1)
+                {
+                    outFile << ";";
+                }
+            }
+
+            outFile << "\n";
+        }
+
+        outFile << "\nEdges:\n";
+        for (const auto& edge : edges)
+        {
+            outFile << escapeField(edge->getSource()->getName()) << ","
+                << escapeField(edge->getDestination()->getName()) << ","
+                << edge->getWeight() << ","
+                << static_cast<int>(edge->getRelationshipType());
+            if (edge->isTemporal())
+            {
+                outFile << "," << formatDate(edge->getValidFrom()) << "," << formatDate(edge->getValidUntil());
+            }
+            outFile << "\n";
+        }
+
+        outFile << "\nEvents:\n";
+        for (const auto& event : events)
+        {
+            outFile << escapeField(event->getName()) << "," << escapeField(event->getDate()) << "\n";
+        }
+
+        outFile << "\nAttendance:\n";
+        for (const auto& attendancePair : attendance)
+        {
+            outFile << escapeField(attendancePair.first) << ",";
+            const auto& attendees = attendancePair.second;
+            for (size_t i = 0; i < attendees.size(); ++i)
+            {
+                outFile << escapeField(attendees[i]);
+                if (i != attendees.size() - 1)
+                {
+                    outFile << ";";
+                }
+            }
+            outFile << "\n";
+        }
+
+        outFile.close();
+        return !outFile.fail();
+    }
+
+public:
+
+    SocialNetwork()
+    {
+        publishSnapshot();
+    }
+
+    // Ids of the current individuals by name; getNode(id) gives their details.
+    const unordered_map<string, uint32_t>& getNodes() const
+    {
+        return nodeIds;
+    }
+
+    const Node& getNode(uint32_t id) const
+    {
+        return nodes[id];
+    }
+
+    const vector<Edge*>& getEdges() const
+    {
+        return edges;
+    }
+
+    bool addNode(const string& name, const string& role, const vector<string>& interests)
+    {
+        if (!insertNode(name, role, interests))
+        {
+            return false;
+        }
+        vector<string> fields = { name, role };
+        fields.insert(fields.end(), interests.begin(), interests.end());
+        logMutation(MUTATION_ADD_NODE, fields);
+        return true;
+    }
+
+    // validFrom and validUntil bound the days on which the relationship holds;
+    // leaving them open makes it valid at all times.
+    bool addEdge(const string& source, const string& destination, double weight, RelationshipType relationshipType,
+        Timestamp validFrom = TIME_MIN, Timestamp validUntil = TIME_MAX)
+    {
+        Edge* edge = insertEdge(source, destination, weight, relationshipType, validFrom, validUntil);
+        if (edge == nullptr)
+        {
+            return false;
+        }
+        if (edge->isTemporal())
+        {
+            temporalEdges.add(nodeIds[source], nodeIds[destination], weight, relationshipType, validFrom, validUntil);
+        }
+        else
+        {
+            temporalEdges.addPermanent();
+        }
+        MutationRecord record = edgeRecord(*edge);
+        logMutation(record.type, record.strings, record.weight, record.relationshipType);
+        return true;
+    }
+
+    // Adds a run of MUTATION_ADD_NODE records, logging them with one append.
+    void addNodes(const vector<MutationRecord>& records, size_t begin, size_t end, vector<bool>& applied)
+    {
+        nodeIds.reserve(nodeIds.size() + (end - begin));
+        vector<MutationRecord> logged;
+        logged.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i)
+        {
+            const vector<string>& s = records[i].strings;
+            applied[i] = !s.empty()
+                && insertNode(s[0], s.size() > 1 ? s[1] : "", vector<string>(s.begin() + min<size_t>(2, s.size()), s.end()));
+            if (applied[i])
+            {
+                logged.push_back(records[i]);
+            }
+        }
+        logMutations(logged);
+    }
+
+    // Adds a run of MUTATION_ADD_EDGE and MUTATION_ADD_TEMPORAL_EDGE records with one
+    // reservation and one append to the mutation log.
+    void addEdges(const vector<MutationRecord>& records, size_t begin, size_t end, vector<bool>& applied)
+    {
+        edges.reserve(edges.size() + (end - begin));
+        vector<TemporalEdge> added;
+        vector<MutationRecord> logged;
+        bool addedPermanent = false;
+        added.reserve(end - begin);
+        logged.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i)
+        {
+            const MutationRecord& record = records[i];
+            const vector<string>& s = record.strings;
+            bool temporal = record.type == MUTATION_ADD_TEMPORAL_EDGE;
+            Timestamp validFrom = TIME_MIN;
+            Timestamp validUntil = TIME_MAX;
+            if (s.size() != (temporal ? 4u : 2u) || (temporal && (!parseTimestamp(s[2], validFrom) || !parseTimestamp(s[3], validUntil))))
+            {
+                applied[i] = false;
+                continue;
+            }
+            RelationshipType type = static_cast<RelationshipType>(record.relationshipType);
+            Edge* edge = insertEdge(s[0], s[1], record.weight, type, validFrom, validUntil);
+            applied[i] = edge != nullptr;
+            if (edge != nullptr)
+            {
+                if (temporal)
+                {
+                    added.push_back({ validFrom, validUntil, nodeIds[s[0]], nodeIds[s[1]], record.weight, static_cast<uint8_t>(type), false });
+                }
+                else
+                {
+                    addedPermanent = true;
+                }
+                logged.push_back(edgeRecord(*edge));
+            }
+        }
+        temporalEdges.addMany(added);
+        if (addedPermanent)
+        {
+            temporalEdges.addPermanent();
+        }
+        logMutations(logged);
+    }
+
+    bool removeNode(const string& name)
+    {
+        auto it = nodeIds.find(name);
+
+        if (it != nodeIds.end())
+        {
+            uint32_t id = it->second;
+            auto touches = [id](const Edge* edge)
+            {
+                return edge->getSource()->getId() == id || edge->getDestination()->getId() == id;
+            };
+            for (const auto& edge : edges)
+            {
+                if (touches(edge))
+                {
+                    markModified(edge->getSource()->getId());
+                    markModified(edge->getDestination()->getId());
+                    if (dynamicCentrality != nullptr)
+                    {
+                        dynamicCentrality->deleteEdge(edge->getSource()->getId(), edge->getDestination()->getId());
+                    }
+                }
+            }
+            unordered_set<uint32_t> endpoints = { id };
+            for (const Edge* edge : outgoingEdges[id])
+            {
+                endpoints.insert(edge->getDestination()->getId());
+            }
+            for (const Edge* edge : incomingEdges[id])
+            {
+                endpoints.insert(edge->getSource()->getId());
+            }
+            unlinkEdges(endpoints, touches);
+            auto kept = stable_partition(edges.begin(), edges.end(), [&touches](const Edge* edge) { return !touches(edge); });
+            for (auto edgeIt = kept; edgeIt != edges.end(); ++edgeIt)
+            {
+                delete *edgeIt;
+            }
+            edges.erase(kept, edges.end());
+
+            if (dynamicCentrality != nullptr)
+            {
+                dynamicCentrality->removeVertex(id);
+            }
+            markModified(id);
+            attributes.remove(id);
+            temporalEdges.removeVertex(id);
+            nodeIds.erase(it);
+            markVertexChanged(id, name, false);
+            logMutation(MUTATION_REMOVE_NODE, { name });
+            return true;
+        }
+
+        else
+        {
+            cout << "Error: Node with name '" << name << "' not found.\n";
+            return false;
+        }
+    }
+
+    // Returns false when no relationship from source to destination exists.
+    bool removeEdge(const string& source, const string& destination)
+    {
+        if (nodeIds.find(source) != nodeIds.end() && nodeIds.find(destination) != nodeIds.end())
+        {
+            markModified(nodeIds[source]);
+            markModified(nodeIds[destination]);
+            temporalEdges.removeEdges(nodeIds[source], nodeIds[destination]);
+            if (dynamicCentrality != nullptr)
+            {
+                for (const auto& edge : edges)
+                {
+                    if (edge->getSource()->getName() == source && edge->getDestination()->getName() == destination)
+                    {
+                        dynamicCentrality->deleteEdge(nodeIds[source], nodeIds[destination]);
+                    }
+                }
+            }
+        }
+        auto matches = [source, destination](const Edge* edge)
+        {
+            return edge->getSource()->getName() == source && edge->getDestination()->getName() == destination;
+        };
+        if (nodeIds.find(source) != nodeIds.end() && nodeIds.find(destination) != nodeIds.end())
+        {
+            unlinkEdges({ nodeIds[source], nodeIds[destination] }, matches);
+        }
+        auto kept = stable_partition(edges.begin(), edges.end(), [&matches](const Edge* edge) { return !matches(edge); });
+        if (kept == edges.end())
+        {
+            return false;
+        }
+        for (auto it = kept; it != edges.end(); ++it)
+        {
+            delete *it;
+        }
+        edges.erase(kept, edges.end());
+        logMutation(MUTATION_REMOVE_EDGE, { source, destination });
+        return true;
+    }
+
+    // Removes several individuals with a single pass over the relationships.
+    // Returns whether each name was removed; a repeated name fails after its first removal.
+    vector<bool> removeNodes(const vector<string>& names)
+    {
+        vector<bool> applied(names.size(), false);
+        unordered_set<uint32_t> removed;
+        for (const auto& name : names)
+        {
+            auto it = nodeIds.find(name);
+            if (it != nodeIds.end())
+            {
+                removed.insert(it->second);
+            }
+        }
+
+        auto touchesRemoved = [&removed](const Edge* edge)
+        {
+            return removed.count(edge->getSource()->getId()) > 0 || removed.count(edge->getDestination()->getId()) > 0;
+        };
+        unordered_set<uint32_t> endpoints = removed;
+        for (const auto& edge : edges)
+        {
+            if (touchesRemoved(edge))
+            {
+                uint32_t source = edge->getSource()->getId();
+                uint32_t destination = edge->getDestination()->getId();
+                markModified(source);
+                markModified(destination);
+                endpoints.insert(source);
+                endpoints.insert(destination);
+                if (dynamicCentrality != nullptr)
+                {
+                    dynamicCentrality->deleteEdge(source, destination);
+                }
+            }
+        }
+        unlinkEdges(endpoints, touchesRemoved);
+        auto kept = stable_partition(edges.begin(), edges.end(), [&touchesRemoved](const Edge* edge) { return !touchesRemoved(edge); });
+        for (auto it = kept; it != edges.end(); ++it)
+        {
+            delete *it;
+        }
+        edges.erase(kept, edges.end());
+
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            const string& name = names[i];
+            auto it = nodeIds.find(name);
+            if (it == nodeIds.end())
+            {
+                cout << "Error: Node with name '" << name << "' not found.\n";
+                continue;
+            }
+            applied[i] = true;
+            uint32_t id = it->second;
+            if (dynamicCentrality != nullptr)
+            {
+                dynamicCentrality->removeVertex(id);
+            }
+            markModified(id);
+            attributes.remove(id);
+            temporalEdges.removeVertex(id);
+            nodeIds.erase(it);
+            markVertexChanged(id, name, false);
+            logMutation(MUTATION_REMOVE_NODE, { name });
+        }
+        return applied;
+    }
+
+    // Removes every relationship between each (source, destination) pair with a
+    // single pass over the relationships. Returns whether each pair had any; a
+    // repeated pair fails after its first removal.
+    vector<bool> removeEdges(const vector<pair<string, string>>& pairs)
+    {
+        set<pair<string, string>> removed(pairs.begin(), pairs.end());
+        unordered_set<uint32_t> endpoints;
+        for (const auto& p : removed)
+        {
+            if (nodeIds.find(p.first) != nodeIds.end() && nodeIds.find(p.second) != nodeIds.end())
+            {
+                markModified(nodeIds[p.first]);
+                markModified(nodeIds[p.second]);
+                endpoints.insert(nodeIds[p.first]);
+                endpoints.insert(nodeIds[p.second]);
+                temporalEdges.removeEdges(nodeIds[p.first], nodeIds[p.second]);
+            }
+        }
+
+        auto matches = [&removed](const Edge* edge)
+        {
+            return removed.count({ edge->getSource()->getName(), edge->getDestination()->getName() }) > 0;
+        };
+        unlinkEdges(endpoints, matches);
+        if (dynamicCentrality != nullptr)
+        {
+            for (const auto& edge : edges)
+            {
+                if (matches(edge))
+                {
+                    dynamicCentrality->deleteEdge(nodeIds[edge->getSource()->getName()], nodeIds[edge->getDestination()->getName()]);
+                }
+            }
+        }
+        auto kept = stable_partition(edges.begin(), edges.end(), [&matches](const Edge* edge) { return !matches(edge); });
+        set<pair<string, string>> found;
+        for (auto it = kept; it != edges.end(); ++it)
+        {
+            found.insert({ (*it)->getSource()->getName(), (*it)->getDestination()->getName() });
+            delete *it;
+        }
+        edges.erase(kept, edges.end());
+
+        vector<bool> applied(pairs.size(), false);
+        for (size_t i = 0; i < pairs.size(); ++i)
+        {
+            applied[i] = found.erase(pairs[i]) > 0;
+            if (applied[i])
+            {
+                logMutation(MUTATION_REMOVE_EDGE, { pairs[i].first, pairs[i].second });
+            }
+        }
+        return applied;
+    }
+
+    // Applies records in order and returns whether each one took effect. Runs of
+    // additions and runs of removals become one bulk operation each, and for large
+    // batches dynamic centrality is rebuilt once at the end instead of being
+    // updated after every relationship.
+    vector<bool> applyMutations(const vector<MutationRecord>& records)
+    {
+        const size_t centralityRebuildThreshold = 64;
+        bool rebuildCentrality = dynamicCentrality != nullptr && records.size() >= centralityRebuildThreshold;
+        bool verifyAfterUpdate = rebuildCentrality && dynamicCentrality->getVerifyAfterUpdate();
+        if (rebuildCentrality)
+        {
+            disableDynamicCentrality();
+        }
+
+        auto isEdgeAddition = [](MutationType type) { return type == MUTATION_ADD_EDGE || type == MUTATION_ADD_TEMPORAL_EDGE; };
+        vector<bool> applied(records.size(), false);
+        for (size_t i = 0; i < records.size();)
+        {
+            size_t j = i;
+            while (j < records.size() && (records[j].type == records[i].type
+                || (isEdgeAddition(records[i].type) && isEdgeAddition(records[j].type))))
+            {
+                ++j;
+            }
+
+            if (records[i].type == MUTATION_ADD_NODE)
+            {
+                addNodes(records, i, j, applied);
+            }
+            else if (isEdgeAddition(records[i].type))
+            {
+                addEdges(records, i, j, applied);
+            }
+            else if (records[i].type == MUTATION_REMOVE_NODE && j - i > 1)
+            {
+                vector<string> names;
+                vector<size_t> positions;
+                for (size_t k = i; k < j; ++k)
+                {
+                    if (records[k].strings.size() == 1)
+                    {
+                        names.push_back(records[k].strings[0]);
+                        positions.push_back(k);
+                    }
+                }
+                vector<bool> removed = removeNodes(names);
+                for (size_t k = 0; k < positions.size(); ++k)
+                {
+                    applied[positions[k]] = removed[k];
+                }
+            }
+            else if (records[i].type == MUTATION_REMOVE_EDGE && j - i > 1)
+            {
+                vector<pair<string, string>> pairs;
+                vector<size_t> positions;
+                for (size_t k = i; k < j; ++k)
+                {
+                    if (records[k].strings.size() == 2)
+                    {
+                        pairs.push_back({ records[k].strings[0], records[k].strings[1] });
+                        positions.push_back(k);
+                    }
+                }
+                vector<bool> removed = removeEdges(pairs);
+                for (size_t k = 0; k < positions.size(); ++k)
+                {
+                    applied[positions[k]] = removed[k];
+                }
+            }
+            else
+            {
+                for (size_t k = i; k < j; ++k)
+                {
+                    applied[k] = applyMutation(records[k]);
+                }
+            }
+            i = j;
+        }
+
+        if (rebuildCentrality)
+        {
+            enableDynamicCentrality();
+            dynamicCentrality->setVerifyAfterUpdate(verifyAfterUpdate);
+        }
+        return applied;
+    }
+
+    uint64_t getModificationCounter() const
+    {
+        return modificationCounter;
+    }
+
+    // Publishes a new immutable version if the graph changed since the last one,
+    // rebuilding only the CSR segments touched by mutations. Writer thread only.
+    void publishSnapshot()
+    {
+        const GraphSnapshot* current = publishedSnapshot.load();
+        if (current != nullptr && current->getVersion() == modificationCounter)
+        {
+            return;
+        }
+
+        shared_ptr<const VertexTable> table = buildVertexTable(current);
+        uint32_t vertexCount = nextNodeId;
+        size_t segmentCount = (vertexCount + SNAPSHOT_SEGMENT_SIZE - 1) / SNAPSHOT_SEGMENT_SIZE;
+        vector<shared_ptr<const CsrSegment>> segments(segmentCount);
+        vector<vector<SegmentEntry>> outEntries(segmentCount);
+        vector<vector<SegmentEntry>> inEntries(segmentCount);
+        vector<bool> rebuild(segmentCount, false);
+        bool anyRebuild = false;
+
+        for (size_t i = 0; i < segmentCount; ++i)
+        {
+            if (!rebuildAllSegments && current != nullptr && i < current->getSegments().size()
+                && dirtySegments.find(static_cast<uint32_t>(i)) == dirtySegments.end())
+            {
+                segments[i] = current->getSegments()[i];
+            }
+            else
+            {
+                rebuild[i] = true;
+                anyRebuild = true;
+            }
+        }
+
+        // Only the incidence lists of vertices in rebuilt segments are visited.
+        for (size_t i = 0; anyRebuild && i < segmentCount; ++i)
+        {
+            uint32_t first = static_cast<uint32_t>(i) * SNAPSHOT_SEGMENT_SIZE;
+            for (uint32_t u = first; rebuild[i] && u < min(vertexCount, first + SNAPSHOT_SEGMENT_SIZE); ++u)
+            {
+                for (const Edge* edge : outgoingEdges[u])
+                {
+                    outEntries[i].push_back({ u - first, edge->getDestination()->getId(), edge->getWeight(),
+                        static_cast<uint8_t>(edge->getRelationshipType()) });
+                }
+                for (const Edge* edge : incomingEdges[u])
+                {
+                    inEntries[i].push_back({ u - first, edge->getSource()->getId(), edge->getWeight(),
+                        static_cast<uint8_t>(edge->getRelationshipType()) });
+                }
+            }
+        }
+
+        for (size_t i = 0; i < segmentCount; ++i)
+        {
+            if (rebuild[i])
+            {
+                auto segment = make_shared<CsrSegment>();
+                uint32_t count = min<uint32_t>(SNAPSHOT_SEGMENT_SIZE, vertexCount - static_cast<uint32_t>(i) * SNAPSHOT_SEGMENT_SIZE);
+                fillCsr(outEntries[i], count, segment->outOffsets, segment->outTargets, segment->outWeights, segment->outTypes);
+                fillCsr(inEntries[i], count, segment->inOffsets, segment->inSources, segment->inWeights, segment->inTypes);
+                segments[i] = segment;
+            }
+        }
+
+        publishedSnapshot.store(new GraphSnapshot(modificationCounter, table, move(segments), edges.size()));
+        if (current != nullptr)
+        {
+            epochs.retire([current]() { delete current; });
+        }
+
+        dirtySegments.clear();
+        dirtyVertexChunks.clear();
+        pendingIdChanges.clear();
+        rebuildAllSegments = false;
+    }
+
+    // Pins the latest published version. Safe to call from any thread; the
+    // snapshot stays valid until the guard is destroyed.
+    SnapshotGuard pinSnapshot()
+    {
+        return SnapshotGuard(epochs, publishedSnapshot);
+    }
+
+    // Counts, for every individual, how many others reach them. Sources are split
+    // across the task scheduler and each chunk accumulates into its own vector.
+    template <typename Graph>
+    static vector<double> computeCommunicationCentrality(const Graph& graph, JobControl* control = nullptr)
+    {
+        uint32_t vertexCount = graph.getVertexCount();
+        vector<double> centrality(vertexCount, 0.0);
+        mutex mergeMutex;
+        if (control != nullptr)
+        {
+            control->setTotal(vertexCount);
+        }
+
+        TaskScheduler& scheduler = TaskScheduler::instance();
+        scheduler.parallelFor(vertexCount, scheduler.grainFor(vertexCount), [&](uint32_t begin, uint32_t end)
+            {
+                vector<double> partial(vertexCount, 0.0);
+                vector<uint32_t> visitedBy(vertexCount, numeric_limits<uint32_t>::max());
+                vector<uint32_t> bfsQueue;
+                bfsQueue.reserve(vertexCount);
+
+                for (uint32_t source = begin; source < end; ++source)
+                {
+                    if (control != nullptr)
+                    {
+                        if (control->isCancelled())
+                        {
+                            return;
+                        }
+                        control->advance();
+                    }
+                    if (!graph.isPresent(source))
+                    {
+                        continue;
+                    }
+
+                    bfsQueue.clear();
+                    bfsQueue.push_back(source);
+                    visitedBy[source] = source;
+
+                    for (size_t head = 0; head < bfsQueue.size(); ++head)
+                    {
+                        graph.forEachOutNeighbor(bfsQueue[head], [&](uint32_t neighbor)
+                            {
+                                if (visitedBy[neighbor] != source)
+                                {
+                                    visitedBy[neighbor] = source;
+                                    bfsQueue.push_back(neighbor);
+                                    partial[neighbor] += 1.0;
+                                }
+                            });
+                    }
+                }
+
+                lock_guard<mutex> lock(mergeMutex);
+                for (uint32_t v = 0; v < vertexCount; ++v)
+                {
+                    centrality[v] += partial[v];
+                }
+            });
+        return centrality;
+    }
+
+    // Brandes' algorithm over directed, unweighted relationships, one BrandesPass per
+    // source. Sources are split across the task scheduler like communication centrality.
+    template <typename Graph>
+    static vector<double> computeBetweennessCentrality(const Graph& graph, JobControl* control = nullptr)
+    {
+        uint32_t vertexCount = graph.getVertexCount();
+        vector<double> betweenness(vertexCount, 0.0);
+        mutex mergeMutex;
+        if (control != nullptr)
+        {
+            control->setTotal(vertexCount);
+        }
+
+        TaskScheduler& scheduler = TaskScheduler::instance();
+        scheduler.parallelFor(vertexCount, scheduler.grainFor(vertexCount), [&](uint32_t begin, uint32_t end)
+            {
+                vector<double> partial(vertexCount, 0.0);
+                BrandesPass pass;
+                pass.resize(vertexCount);
+
+                for (uint32_t source = begin; source < end; ++source)
+                {
+                    if (control != nullptr)
+                    {
+                        if (control->isCancelled())
+                        {
+                            return;
+                        }
+                        control->advance();
+                    }
+                    if (!graph.isPresent(source))
+                    {
+                        continue;
+                    }
+                    pass.run(graph, source, [&](uint32_t v, double dependency) { partial[v] += dependency; });
+                }
+
+                lock_guard<mutex> lock(mergeMutex);
+                for (uint32_t v = 0; v < vertexCount; ++v)
+                {
+                    betweenness[v] += partial[v];
+                }
+            });
+        return betweenness;
+    }
+
+    static vector<vector<string>> computeCollaborationNetworks(const GraphSnapshot& graph, JobControl* control = nullptr)
+    {
+        uint32_t vertexCount = graph.getVertexCount();
+        vector<uint32_t> community(vertexCount);
+        vector<double> communityInternalWeights(vertexCount, 0.0);
+        vector<tuple<double, uint32_t, uint32_t>> weightedEdges;
+
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            community[v] = v;
+            if (!graph.isPresent(v))
+            {
+                continue;
+            }
+            AdjacencyRange adjacency = graph.outEdges(v);
+            for (uint32_t i = 0; i < adjacency.size(); ++i)
+            {
+                weightedEdges.emplace_back(adjacency.weights[i], v, adjacency.vertices[i]);
+            }
+        }
+
+        stable_sort(weightedEdges.begin(), weightedEdges.end(),
+            [](const auto& e1, const auto& e2) { return get<0>(e1) > get<0>(e2); });
+        if (control != nullptr)
+        {
+            control->setTotal(weightedEdges.size());
+        }
+
+        for (const auto& edge : weightedEdges)
+        {
+            if (control != nullptr)
+            {
+                if (control->isCancelled())
+                {
+                    return {};
+                }
+                control->advance();
+            }
+            double weight = get<0>(edge);
+            uint32_t sourceCommunity = community[get<1>(edge)];
+            uint32_t destCommunity = community[get<2>(edge)];
+
+            if (sourceCommunity != destCommunity) {
+                double internalWeight = communityInternalWeights[sourceCommunity] +
+                    communityInternalWeights[destCommunity] + weight;
+                double modularityGain = internalWeight - weight;
+
+                if (modularityGain > 0) {
+                    communityInternalWeights[sourceCommunity] += weight;
+                    communityInternalWeights[destCommunity] += weight;
+
+                    for (auto& member : community) {
+                        if (member == destCommunity) {
+                            member = sourceCommunity;
+                        }
+                    }
+                }
+            }
+        }
+
+        vector<vector<string>> communities;
+        unordered_map<uint32_t, size_t> communityIndex;
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            if (!graph.isPresent(v))
+            {
+                continue;
+            }
+            auto inserted = communityIndex.insert({ community[v], communities.size() });
+            if (inserted.second)
+            {
+                communities.emplace_back();
+            }
+            communities[inserted.first->second].push_back(graph.getName(v));
+        }
+        return communities;
+    }
+
+    void displayNodeDetails(const string& nodeName)
+    {
+        auto idIt = nodeIds.find(nodeName);
+        if (idIt == nodeIds.end())
+        {
+            cerr << "Error: Node not found.\n";
+            return;
+        }
+
+        cout << "Details of " << nodeName << " - Role: " << nodes[idIt->second].getRole()
+            << ", Interests: ";
+
+        for (const auto& interest : nodes[idIt->second].getInterests())
+        {
+            cout << interest << " ";
+        }
+
+        cout << "\nRelationships: ";
+
+        for (const auto& edge : edges)
+        {
+            if (edge->getSource()->getName() == nodeName)
+            {
+
+                cout << edge->getDestination()->getName() << " (Weight: " << edge->getWeight()
+                    << ", Relationship Type: " << RelationshipNames[edge->getRelationshipType()] << ") ";
+            }
+
+            else if (edge->getDestination()->getName() == nodeName)
+            {
+                cout << edge->getSource()->getName() << " (Weight: " << edge->getWeight()
+                    << ", Relationship Type: " << RelationshipNames[edge->getRelationshipType()] << ") ";
+            }
+
+
+        }
+        cout << endl;
+
+
+    }
+
+    void displayAllNodes()
+    {
+
+        for (const auto& idPair : nodeIds)
+        {
+            displayNodeDetails(idPair.first);
+        }
+    }
+
+    void visualizeGraph()
+    {
+        cout << "Visualizing Network Graph:\n";
+        queue<Node*> nodeQueue;
+        unordered_map<Node*, bool> visited;
+        for (const auto& idPair : nodeIds)
+        {
+            Node* currentNode = &nodes[idPair.second];
+            nodeQueue.push(currentNode);
+            visited[currentNode] = false;
+        }
+        while (!nodeQueue.empty())
+        {
+            Node* currentNode = nodeQueue.front();
+            nodeQueue.pop();
+            if (!visited[currentNode])
+            {
+                visited[currentNode] = true;
+                cout << "Node: " << currentNode->getName() << " (Role: " << currentNode->getRole() << ")\n";
+
+                for (const auto& edge : edges)
+                {
+                    if (edge->getSource() == currentNode)
+                    {
+                        cout << "  -> " << edge->getDestination()->getName()
+                            << " (Weight: " << edge->getWeight()
+                            << ", Relationship Type: " << RelationshipNames[edge->getRelationshipType()] << ")\n";
+                        nodeQueue.push(edge->getDestination());
+
+                    }
+
+                    else if (edge->getDestination() == currentNode)
+                    {
+
+                        cout << "  <- " << edge->getSource()->getName()
+                            << " (Weight: " << edge->getWeight()
+                            << ", Relationship Type: " << RelationshipNames[edge->getRelationshipType()] << ")\n";
+                        nodeQueue.push(edge->getSource());
+
+                    }
+                }
+            }
+        }
+    }
+
+    // Seeds the cache with the incrementally maintained scores so the reports
+    // below do not recompute them. Writer thread only.
+    void cacheDynamicCentrality(const GraphSnapshot& graph)
+    {
+        if (dynamicCentrality == nullptr)
+        {
+            return;
+        }
+        analysisCache.getOrCompute<vector<double>>("communication-centrality", "", graph.getVersion(),
+            [this]() { return dynamicCentrality->getReach(); });
+        analysisCache.getOrCompute<vector<double>>("betweenness-centrality", "", graph.getVersion(),
+            [this]() { return dynamicCentrality->getBetweenness(); });
+    }
+
+    // The report* methods only read the given snapshot and the analysis cache, so
+    // background jobs can run them while the graph is being edited.
+    void reportHighestCentrality(const GraphSnapshot& graph, ostream& out, JobControl* control = nullptr,
+        ReportData* data = nullptr)
+    {
+        auto cached = analysisCache.getOrCompute<vector<double>>(
+            "communication-centrality", "", graph.getVersion(),
+            [this, &graph, control]()
+            {
+                return withDirectedAdjacency(graph,
+                    [control](const auto& adjacency) { return computeCommunicationCentrality(adjacency, control); });
+            }, control);
+        if (control != nullptr && control->isCancelled())
+        {
+            return;
+        }
+        const vector<double>& centrality = *cached;
+
+        int best = -1;
+        for (uint32_t v = 0; v < centrality.size(); ++v)
+        {
+            if (graph.isPresent(v) && (best < 0 || centrality[v] > centrality[best]))
+            {
+                best = static_cast<int>(v);
+            }
+        }
+
+        if (best < 0)
+        {
+            out << "The network has no individuals.\n";
+            return;
+        }
+
+        out << "Individual with the highest communication centrality: "
+            << graph.getName(best)
+            << " (Centrality: " << centrality[best] << ")\n";
+        if (data != nullptr)
+        {
+            data->rankings.push_back({ "highest", { { graph.getName(best), centrality[best] } } });
+        }
+    }
+
+    void findHighestCentrality(ReportData* data = nullptr)
+    {
+        publishSnapshot();
+        SnapshotGuard snapshot = pinSnapshot();
+        cacheDynamicCentrality(snapshot.get());
+        reportHighestCentrality(snapshot.get(), cout, nullptr, data);
+    }
+
+    void reportCollaborationNetworks(const GraphSnapshot& graph, ostream& out, JobControl* control = nullptr,
+        ReportData* data = nullptr)
+    {
+        auto communities = analysisCache.getOrCompute<vector<vector<string>>>(
+            "collaboration-networks", "", graph.getVersion(),
+            [&graph, control]() { return computeCollaborationNetworks(graph, control); }, control);
+        if (control != nullptr && control->isCancelled())
+        {
+            return;
+        }
+
+        int communityNumber = 1;
+        for (const auto& comm : *communities)
+        {
+            out << "Community " << communityNumber++ << ": ";
+            for (const auto& member : comm)
+            {
+                out << member << " ";
+            }
+
+
+            out << endl;
+        }
+        if (data != nullptr)
+        {
+            data->groupings.push_back({ "communities", *communities });
+        }
+
+
+    }
+
+    void identifyCollaborationNetworks(ReportData* data = nullptr)
+    {
+        publishSnapshot();
+        SnapshotGuard snapshot = pinSnapshot();
+        reportCollaborationNetworks(snapshot.get(), cout, nullptr, data);
+    }
+
+    void determineInfluentialByDegreeCentrality(ReportData* data = nullptr)
+    {
+        publishSnapshot();
+        SnapshotGuard snapshot = pinSnapshot();
+        const GraphSnapshot& graph = snapshot.get();
+
+        // A relationship counts for both of its endpoints, so the degree is the sum
+        // of the snapshot's out- and in-degree and needs no undirected copy.
+        uint32_t maxDegree = 0;
+        vector<uint32_t> influentialNodes;
+
+        for (uint32_t v = 0; v < graph.getVertexCount(); ++v)
+        {
+            uint32_t degree = graph.outEdges(v).size() + graph.inEdges(v).size();
+            if (degree == 0)
+            {
+                continue;
+            }
+
+            if (degree > maxDegree)
+            {
+                maxDegree = degree;
+                influentialNodes.clear();
+                influentialNodes.push_back(v);
+            }
+            else if (degree == maxDegree)
+            {
+                influentialNodes.push_back(v);
+            }
+        }
+
+        cout << "Most influential individuals by degree centrality:\n";
+        vector<pair<string, double>> ranked;
+        for (uint32_t v : influentialNodes)
+        {
+            cout << graph.getName(v) << " (Degree Centrality: " << maxDegree << ")\n";
+            ranked.push_back({ graph.getName(v), maxDegree });
+        }
+        if (data != nullptr)
+        {
+            data->rankings.push_back({ "degree", ranked });
+        }
+    }
+
+    // Compares every weight/direction specialization of the graph core on the
+    // current network, running hop BFS from up to sourceCount individuals.
+    void benchmarkGraphSpecializations(uint32_t sourceCount)
+    {
+        publishSnapshot();
+        SnapshotGuard snapshot = pinSnapshot();
+        const GraphSnapshot& graph = snapshot.get();
+
+        vector<uint32_t> sources;
+        for (uint32_t v = 0; v < graph.getVertexCount() && sources.size() < sourceCount; ++v)
+        {
+            if (graph.isPresent(v))
+            {
+                sources.push_back(v);
+            }
+        }
+
+        cout << left << setw(12) << "Weight" << setw(12) << "Direction" << right << setw(12) << "Bytes"
+            << setw(11) << "Build ms" << setw(11) << "BFS ms" << setw(11) << "Scan ms" << "\n";
+        benchmarkSpecialization<Unweighted, Directed>(graph, sources);
+        benchmarkSpecialization<uint8_t, Directed>(graph, sources);
+        benchmarkSpecialization<float, Directed>(graph, sources);
+        benchmarkSpecialization<double, Directed>(graph, sources);
+        benchmarkSpecialization<Unweighted, Undirected>(graph, sources);
+        benchmarkSpecialization<uint8_t, Undirected>(graph, sources);
+        benchmarkSpecialization<float, Undirected>(graph, sources);
+        benchmarkSpecialization<double, Undirected>(graph, sources);
+    }
+    
+    void reportBetweennessCentrality(const GraphSnapshot& graph, ostream& out, JobControl* control = nullptr,
+        ReportData* data = nullptr)
+    {
+        auto cached = analysisCache.getOrCompute<vector<double>>(
+            "betweenness-centrality", "", graph.getVersion(),
+            [this, &graph, control]()
+            {
+                return withDirectedAdjacency(graph,
+                    [control](const auto& adjacency) { return computeBetweennessCentrality(adjacency, control); });
+            }, control);
+        if (control != nullptr && control->isCancelled())
+        {
+            return;
+        }
+        const vector<double>& betweennessCentrality = *cached;
+
+        double maxBetweenness = 0.0;
+        vector<uint32_t> influentialNodes;
+
+        for (uint32_t v = 0; v < betweennessCentrality.size(); ++v)
+        {
+            if (!graph.isPresent(v))
+            {
+                continue;
+            }
+
+            if (betweennessCentrality[v] > maxBetweenness)
+            {
+                maxBetweenness = betweennessCentrality[v];
+                influentialNodes.clear();
+                influentialNodes.push_back(v);
+            }
+
+            else if (betweennessCentrality[v] == maxBetweenness)
+            {
+                influentialNodes.push_back(v);
+            }
+        }
+
+
+
+        out << "\nMost influential individuals by betweenness centrality:\n";
+        vector<pair<string, double>> ranked;
+        for (uint32_t v : influentialNodes)
+        {
+
+            out << graph.getName(v) << " (Betweenness Centrality: " << betweennessCentrality[v] << ")\n";
+            ranked.push_back({ graph.getName(v), betweennessCentrality[v] });
+        }
+        if (data != nullptr)
+        {
+            data->rankings.push_back({ "betweenness", ranked });
+        }
+    }
+
+    void determineInfluentialByBetweennessCentrality(ReportData* data = nullptr)
+    {
+        publishSnapshot();
+        SnapshotGuard snapshot = pinSnapshot();
+        cacheDynamicCentrality(snapshot.get());
+        reportBetweennessCentrality(snapshot.get(), cout, nullptr, data);
+    }
+
+    void identifySocialClusters(ReportData* data = nullptr)
+    {
+        unordered_map<string, int> communitySize;
+
+        for (const auto& edge : edges)
+        {
+            communitySize[edge->getSource()->getName()]++;
+            communitySize[edge->getDestination()->getName()]++;
+        }
+
+
+        int maxEdges = 0;
+        vector<string> socialClusters;
+
+
+        for (const auto& node : communitySize)
+        {
+            if (node.second > maxEdges)
+            {
+                maxEdges = node.second;
+                socialClusters.clear();
+                socialClusters.push_back(node.first);
+            }
+
+            else if (node.second == maxEdges)
+            {
+                socialClusters.push_back(node.first);
+            }
+
+        }
+
+        cout << "Social Clusters (Nodes with Maximum Edges):\n";
+        vector<pair<string, double>> ranked;
+        for (const auto& nodeName : socialClusters)
+        {
+            cout << nodeName << " (Edges: " << communitySize[nodeName] << ")\n";
+            ranked.push_back({ nodeName, communitySize[nodeName] });
+        }
+        if (data != nullptr)
+        {
+            data->rankings.push_back({ "edges", ranked });
+        }
+    }
+
+    bool addEvent(const string& name, const string& date)
+    {
+        events.push_back(new Event(name, date));
+        attendance[name] = vector<string>();
+        logMutation(MUTATION_ADD_EVENT, { name, date });
+        return true;
+    }
+
+    bool removeEvent(const string& name)
+    {
+        auto it = find_if(events.begin(), events.end(), [&name](const Event* event)
+            {
                 return event->getName() == name;
             });
 
-        if (it != events.end())
+        if (it != events.end())
+        {
+            attendance.erase(name);
+            delete* it;
+            events.erase(it);
+            logMutation(MUTATION_REMOVE_EVENT, { name });
+            return true;
+        }
+        else
+        {
+            cerr << "Error: Event with name '" << name << "' not found.\n";
+            return false;
+        }
+
+
+    }
+
+    bool markAttendance(const string& eventName, const string& attendeeName) {
+
+
+        if (attendance.find(eventName) == attendance.end() || nodeIds.find(attendeeName) == nodeIds.end())
+        {
+            cerr << "Error: Event or node not found while marking attendance.\n";
+            return false;
+        }
+
+        attendance[eventName].push_back(attendeeName);
+        logMutation(MUTATION_MARK_ATTENDANCE, { eventName, attendeeName });
+        return true;
+    }
+
+    void displayEventDetails(const string& eventName) {
+        auto it = find_if(events.begin(), events.end(), [&eventName](const Event* event) {
+            return event->getName() == eventName;
+            });
+
+        if (it != events.end())
+        {
+            cout << "Event: " << (*it)->getName() << ", Date: " << (*it)->getDate() << "\n";
+            cout << "Attendance: ";
+            for (const auto& attendee : attendance[(*it)->getName()]) {
+                cout << attendee << " ";
+            }
+
+            cout << "\n";
+        }
+
+        else
+        {
+            cerr << "Error: Event not found.\n";
+        }
+
+
+    }
+
+    void storeGraphDetailsToFile(const string& filename) {
+        if (writeGraphDetails(filename))
+        {
+            cout << "Graph details have been stored in the file: " << filename << endl;
+            // An oracle file left over from an earlier save would describe a different graph.
+            error_code error;
+            if (distanceOracle.isBuilt() && distanceOracle.getVersion() == modificationCounter)
+            {
+                if (distanceOracle.save(filename + ".pll"))
+                {
+                    cout << "Distance oracle has been stored in the file: " << filename << ".pll" << endl;
+                }
+                else
+                {
+                    cerr << "Error: Could not store the distance oracle in " << filename << ".pll\n";
+                    filesystem::remove(filename + ".pll", error);
+                }
+            }
+            else if (filesystem::remove(filename + ".pll", error))
+            {
+                cout << "Removed the outdated distance oracle file: " << filename << ".pll" << endl;
+            }
+        }
+        else
+        {
+            cerr << "Unable to open file: " << filename << endl;
+        }
+    }
+
+    void loadGraphDetailsFromFile(const string& filename)
+    {
+        ifstream inFile(filename);
+
+        if (!inFile.is_open())
+        {
+            cerr << "Unable to open file: " << filename << endl;
+            return;
+        }
+
+        auto split = [](const string& text, char delimiter)
+        {
+            vector<string> parts = splitFields(text, delimiter);
+            for (auto& part : parts)
+            {
+                part = unescapeField(part);
+            }
+            return parts;
+        };
+
+        string line;
+        string section;
+        while (getline(inFile, line))
+        {
+            if (line.empty())
+            {
+                continue;
+            }
+            if (line == "Nodes:" || line == "Edges:" || line == "Events:" || line == "Attendance:")
+            {
+                section = line;
+                continue;
+            }
+
+            vector<string> fields = splitFields(line, ',');
+            auto field = [&fields](size_t index) { return unescapeField(fields[index]); };
+            if (section == "Nodes:" && fields.size() >= 3)
+            {
+                vector<string> interests;
+                if (!fields[2].empty())
+                {
+                    interests = split(fields[2], ';');
+                }
+                addNode(field(0), field(1), interests);
+            }
+            else if (section == "Edges:" && (fields.size() == 4 || fields.size() == 6))
+            {
+                Timestamp validFrom = TIME_MIN;
+                Timestamp validUntil = TIME_MAX;
+                if (fields.size() == 6 && ((!fields[4].empty() && !parseDate(field(4), validFrom))
+                    || (!fields[5].empty() && !parseDate(field(5), validUntil))))
+                {
+                    cerr << "Error: Invalid validity dates on relationship line: " << line << "\n";
+                    continue;
+                }
+                addEdge(field(0), field(1), stod(field(2)), static_cast<RelationshipType>(stoi(field(3))),
+                    validFrom, validUntil);
+            }
+            else if (section == "Events:" && fields.size() >= 2)
+            {
+                addEvent(field(0), field(1));
+            }
+            else if (section == "Attendance:" && fields.size() >= 2 && !fields[1].empty())
+            {
+                for (const auto& attendee : split(fields[1], ';'))
+                {
+                    markAttendance(field(0), attendee);
+                }
+            }
+        }
+
+        if (filesystem::exists(filename + ".pll"))
+        {
+            loadDistanceOracle(filename);
+        }
+    }
+
+    // Replaces the in-memory graph with the latest snapshot of basePath plus every
+    // logged mutation after it, then appends all further mutations to a fresh segment.
+    void openPersistentStore(const string& basePath, size_t groupCommitSize = 64)
+    {
+        closePersistentStore();
+        clear();
+
+        vector<uint64_t> snapshots = MutationLog::listSequences(basePath, ".snapshot.");
+        vector<uint64_t> segments = MutationLog::listSequences(basePath, ".wal.");
+        bool hasSnapshot = !snapshots.empty();
+        uint64_t nextSequence = 0;
+        size_t replayed = 0;
+
+        if (hasSnapshot)
+        {
+            loadGraphDetailsFromFile(MutationLog::snapshotPath(basePath, snapshots.back()));
+            nextSequence = snapshots.back() + 1;
+        }
+
+        for (uint64_t sequence : segments)
+        {
+            if (!hasSnapshot || sequence > snapshots.back())
+            {
+                vector<MutationRecord> records = MutationLog::readSegment(MutationLog::segmentPath(basePath, sequence));
+                applyMutations(records);
+                replayed += records.size();
+            }
+            nextSequence = max(nextSequence, sequence + 1);
+        }
+
+        mutationLog = new MutationLog(basePath, nextSequence, groupCommitSize);
+        cout << "Opened persistent store " << basePath << " (" << nodeIds.size() << " nodes, "
+            << edges.size() << " edges, " << replayed << " logged mutations replayed).\n";
+    }
+
+    void commitMutations()
+    {
+        if (mutationLog == nullptr)
+        {
+            return;
+        }
+        mutationLog->commit();
+        if (mutationLog->getRecordsSinceCompaction() >= compactionThreshold)
+        {
+            compactMutationLog();
+        }
+    }
+
+    // Seals the active log segment and folds it into a new snapshot on a background thread.
+    void compactMutationLog()
+    {
+        if (mutationLog == nullptr)
+        {
+            cerr << "Error: No persistent store is open.\n";
+            return;
+        }
+        if (compactionThread.joinable())
+        {
+            compactionThread.join();
+        }
+
+        uint64_t sealed = mutationLog->rotate();
+        compactionThread = thread(&SocialNetwork::compactSegments, mutationLog->getBasePath(), sealed);
+    }
+
+    void closePersistentStore()
+    {
+        if (compactionThread.joinable())
+        {
+            compactionThread.join();
+        }
+        delete mutationLog;
+        mutationLog = nullptr;
+    }
+
+    // Bellman-Ford from source over the edges of its weakly connected component;
+    // stops early once a pass relaxes nothing.
+    void reportNegativeInfluencePaths(const GraphSnapshot& graph, const string& source, ostream& out,
+        JobControl* control = nullptr)
+    {
+        uint32_t sourceId;
+        if (!graph.findVertex(source, sourceId))
+        {
+            cerr << "Error: Node not found.\n";
+            return;
+        }
+
+        auto components = getWeakComponents(graph);
+        auto influence = getTypedGraph<double, Directed>(graph);
+        uint32_t sourceComponent = (*components)[sourceId];
+        uint32_t vertexCount = graph.getVertexCount();
+
+        vector<uint32_t> componentVertices;
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            if ((*components)[v] == sourceComponent)
+            {
+                componentVertices.push_back(v);
+            }
+        }
+
+        vector<double> distance(vertexCount, numeric_limits<double>::infinity());
+        vector<uint32_t> predecessor(vertexCount, NO_COMPONENT);
+        distance[sourceId] = 0.0;
+        if (control != nullptr)
+        {
+            control->setTotal(componentVertices.size());
+        }
+
+        for (size_t i = 0; i + 1 < componentVertices.size(); ++i)
+        {
+            if (control != nullptr)
+            {
+                if (control->isCancelled())
+                {
+                    return;
+                }
+                control->advance();
+            }
+            bool relaxed = false;
+            for (uint32_t u : componentVertices)
+            {
+                influence->forEachOutEdge(u, [&](uint32_t v, double weight)
+                    {
+                        if (distance[u] + weight < distance[v])
+                        {
+                            distance[v] = distance[u] + weight;
+                            predecessor[v] = u;
+                            relaxed = true;
+                        }
+                    });
+            }
+            if (!relaxed)
+            {
+                break;
+            }
+        }
+        for (uint32_t u : componentVertices)
+        {
+            influence->forEachOutEdge(u, [&](uint32_t v, double weight)
+                {
+                    if (distance[u] + weight < distance[v])
+                    {
+                        out << "Negative influence path detected from " << source << " to " << graph.getName(v) << ".\n";
+
+                        vector<uint32_t> cycle;
+                        uint32_t current = v;
+                        while (current != NO_COMPONENT && cycle.size() <= componentVertices.size())
+                        {
+                            cycle.push_back(current);
+                            current = predecessor[current];
+                            if (current == v)
+                            {
+                                cycle.push_back(current);
+                                break;
+                            }
+                        }
+
+
+                        out << "Cycle: ";
+                        for (auto it = cycle.rbegin(); it != cycle.rend(); ++it)
+                        {
+                            out << graph.getName(*it) << " ";
+                        }
+                        out << endl;
+                    }
+                });
+        }
+    }
+
+    void detectNegativeInfluencePaths(const string& source)
+    {
+        publishSnapshot();
+        SnapshotGuard snapshot = pinSnapshot();
+        reportNegativeInfluencePaths(snapshot.get(), source, cout);
+    }
+
+    shared_ptr<const vector<uint32_t>> getWeakComponents(const GraphSnapshot& graph)
+    {
+        return analysisCache.getOrCompute<vector<uint32_t>>("weak-components", "", graph.getVersion(),
+            [&graph]() { return ConnectedComponents::weak(graph); });
+    }
+
+    shared_ptr<const vector<uint32_t>> getStrongComponents(const GraphSnapshot& graph)
+    {
+        return analysisCache.getOrCompute<vector<uint32_t>>("strong-components", "", graph.getVersion(),
+            [&graph]() { return ConnectedComponents::strong(graph); });
+    }
+
+    void reportConnectedComponents(const GraphSnapshot& graph, ostream& out, JobControl* control = nullptr,
+        ReportData* data = nullptr)
+    {
+        const size_t listed = 10;
+
+        for (int strong = 0; strong < 2; ++strong)
+        {
+            if (control != nullptr && control->isCancelled())
+            {
+                return;
+            }
+            auto labels = strong ? getStrongComponents(graph) : getWeakComponents(graph);
+            vector<vector<string>> members(ConnectedComponents::countComponents(*labels));
+            for (uint32_t v = 0; v < labels->size(); ++v)
+            {
+                if ((*labels)[v] != NO_COMPONENT)
+                {
+                    members[(*labels)[v]].push_back(graph.getName(v));
+                }
+            }
+            stable_sort(members.begin(), members.end(),
+                [](const vector<string>& a, const vector<string>& b) { return a.size() > b.size(); });
+
+            out << (strong ? "Strongly" : "Weakly") << " connected components: " << members.size() << "\n";
+            for (size_t c = 0; c < members.size() && c < listed; ++c)
+            {
+                out << "Component " << c + 1 << " (" << members[c].size() << " individuals): ";
+                for (const auto& member : members[c])
+                {
+                    out << member << " ";
+                }
+                out << endl;
+            }
+            if (members.size() > listed)
+            {
+                out << "... " << members.size() - listed << " smaller components not shown\n";
+            }
+            if (data != nullptr)
+            {
+                data->groupings.push_back({ strong ? "strong" : "weak", move(members) });
+            }
+        }
+    }
+
+    void displayConnectedComponents(ReportData* data = nullptr)
+    {
+        publishSnapshot();
+        SnapshotGuard snapshot = pinSnapshot();
+        reportConnectedComponents(snapshot.get(), cout, nullptr, data);
+    }
+
+    // Scans the attribute columns for members with the given role and interest;
+    // either may be empty to match everyone.
+    void findMembersByAttributes(const string& role, const string& interest, ReportData* data = nullptr)
+    {
+        publishSnapshot();
+        SnapshotGuard snapshot = pinSnapshot();
+
+        auto start = chrono::steady_clock::now();
+        vector<uint32_t> matches = attributes.select(role, interest);
+        auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+
+        cout << matches.size() << " member(s) found in " << elapsed.count() << " us:\n";
+        vector<string> names;
+        for (uint32_t id : matches)
+        {
+            cout << snapshot->getName(id) << " (Role: " << snapshot->getRole(id) << ")\n";
+            names.push_back(snapshot->getName(id));
+        }
+        if (data != nullptr)
+        {
+            data->lists.push_back({ "members", names });
+        }
+    }
+
+    void displayAttributeStorageReport() const
+    {
+        cout << "Distinct roles: " << attributes.getRoleNames().size()
+            << ", dictionary entries: " << attributes.getDictionary().size() << "\n";
+        cout << "Columnar attributes: " << attributes.getMemoryUsage() << " bytes, row-wise strings would use "
+            << attributes.getRowWiseMemoryUsage() << " bytes\n";
+    }
+
+    // Prim's algorithm over an undirected typed view, run once per weakly connected
+    // component and starting with the component of start. A heap entry is only
+    // pushed when it lowers the best known cost of joining its vertex to the tree.
+    template <typename Weight>
+    static SpanningForest primSpanningForest(const TypedGraph<Weight, Undirected>& graph,
+        const vector<uint32_t>& components, uint32_t start)
+    {
+        uint32_t vertexCount = graph.getVertexCount();
+        uint32_t componentCount = ConnectedComponents::countComponents(components);
+        vector<uint32_t> componentRoots(componentCount, NO_COMPONENT);
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            if (components[v] != NO_COMPONENT && componentRoots[components[v]] == NO_COMPONENT)
+            {
+                componentRoots[components[v]] = v;
+            }
+        }
+        uint32_t startComponent = components[start];
+        componentRoots[startComponent] = start;
+
+        SpanningForest forest;
+        vector<double> cost(vertexCount, numeric_limits<double>::infinity());
+        vector<uint32_t> parent(vertexCount, NO_COMPONENT);
+        vector<bool> inTree(vertexCount, false);
+        priority_queue<pair<double, uint32_t>, vector<pair<double, uint32_t>>, greater<>> pq;
+        for (uint32_t offset = 0; offset < componentCount; ++offset)
+        {
+            uint32_t root = componentRoots[(startComponent + offset) % componentCount];
+            if (graph.getDegree(root) == 0 && offset > 0)
+            {
+                ++forest.isolatedCount;
+                continue;
+            }
+
+            vector<pair<string, string>> treeEdges;
+            cost[root] = 0.0;
+            pq.push({ 0.0, root });
+            while (!pq.empty())
+            {
+                uint32_t current = pq.top().second;
+                pq.pop();
+                if (inTree[current])
+                {
+                    continue;
+                }
+                inTree[current] = true;
+                if (parent[current] != NO_COMPONENT)
+                {
+                    treeEdges.push_back({ graph.getName(parent[current]), graph.getName(current) });
+                }
+
+                graph.forEachOutEdge(current, [&](uint32_t neighbor, double weight)
+                    {
+                        if (!inTree[neighbor] && weight < cost[neighbor])
+                        {
+                            cost[neighbor] = weight;
+                            parent[neighbor] = current;
+                            pq.push({ weight, neighbor });
+                        }
+                    });
+            }
+            forest.roots.push_back(graph.getName(root));
+            forest.trees.push_back(move(treeEdges));
+        }
+        return forest;
+    }
+
+    SpanningForest computeMinimumSpanningTree(const string& startNode)
+    {
+        publishSnapshot();
+        SnapshotGuard snapshot = pinSnapshot();
+        auto components = getWeakComponents(snapshot.get());
+        auto relationships = getTypedGraph<double, Undirected>(snapshot.get());
+        return primSpanningForest(*relationships, *components, nodeIds[startNode]);
+    }
+
+    void findMinimumSpanningTree(const string& startNode)
+    {
+        if (nodeIds.find(startNode) == nodeIds.end())
+        {
+            cerr << "Error: Start node not found.\n";
+            return;
+        }
+
+        auto forest = analysisCache.getOrCompute<SpanningForest>(
+            "minimum-spanning-tree", startNode, modificationCounter,
+            [this, &startNode]() { return computeMinimumSpanningTree(startNode); });
+
+        for (size_t t = 0; t < forest->trees.size(); ++t)
+        {
+            if (t == 1)
+            {
+                cout << "Individuals not connected to " << startNode << " form separate spanning trees:\n";
+            }
+            cout << (t == 0 ? "Minimum Spanning Tree from " : "Spanning tree from ") << forest->roots[t] << ":\n";
+            for (const auto& treeEdge : forest->trees[t])
+            {
+                cout << "Edge: " << treeEdge.first << " - " << treeEdge.second << "\n";
+            }
+        }
+        if (forest->isolatedCount > 0)
+        {
+            cout << forest->isolatedCount << " individual(s) have no relationships.\n";
+        }
+    }
+
+    // Starts maintaining centrality incrementally; every later addEdge/removeEdge
+    // only recomputes the sources whose shortest paths it can change.
+    void enableDynamicCentrality()
+    {
+        if (dynamicCentrality != nullptr)
+        {
+            return;
+        }
+        dynamicCentrality = new DynamicCentrality();
+        for (const auto& idPair : nodeIds)
+        {
+            dynamicCentrality->addVertex(idPair.second, idPair.first);
+        }
+        for (const auto& edge : edges)
+        {
+            dynamicCentrality->loadEdge(nodeIds[edge->getSource()->getName()], nodeIds[edge->getDestination()->getName()]);
+        }
+        dynamicCentrality->recomputeAll();
+    }
+
+    void disableDynamicCentrality()
+    {
+        delete dynamicCentrality;
+        dynamicCentrality = nullptr;
+    }
+
+    void displayDynamicCentrality()
+    {
+        if (dynamicCentrality == nullptr)
+        {
+            cerr << "Error: Dynamic centrality is not enabled.\n";
+            return;
+        }
+
+        auto best = [this](const vector<double>& values)
+        {
+            string bestName;
+            double bestValue = -1.0;
+            for (const auto& idPair : nodeIds)
+            {
+                if (values[idPair.second] > bestValue)
+                {
+                    bestValue = values[idPair.second];
+                    bestName = idPair.first;
+                }
+            }
+            return make_pair(bestName, bestValue);
+        };
+
+        if (nodeIds.empty())
+        {
+            cout << "The network has no individuals.\n";
+            return;
+        }
+
+        auto closest = best(dynamicCentrality->getCloseness());
+        auto between = best(dynamicCentrality->getBetweenness());
+        auto reached = best(dynamicCentrality->getReach());
+        cout << "Highest closeness centrality: " << closest.first << " (" << closest.second << ")\n";
+        cout << "Highest betweenness centrality: " << between.first << " (" << between.second << ")\n";
+        cout << "Highest communication centrality: " << reached.first << " (" << reached.second << ")\n";
+        cout << dynamicCentrality->getUpdateCount() << " incremental updates recomputed "
+            << dynamicCentrality->getSourcesRecomputed() << " single-source passes.\n";
+    }
+
+    void verifyDynamicCentrality()
+    {
+        if (dynamicCentrality == nullptr)
+        {
+            cerr << "Error: Dynamic centrality is not enabled.\n";
+            return;
+        }
+        size_t mismatches = dynamicCentrality->verify();
+        cout << "Dynamic centrality verification: " << mismatches << " mismatches against a full recomputation.\n";
+    }
+
+    void setDynamicCentralityVerification(bool enabled)
+    {
+        if (dynamicCentrality != nullptr)
+        {
+            dynamicCentrality->setVerifyAfterUpdate(enabled);
+        }
+    }
+
+    // While enabled, the cached flat ReachGraph is dropped in favour of the compressed form.
+    void setCompressedAdjacency(bool enabled)
+    {
+        useCompressedAdjacency = enabled;
+        if (enabled)
+        {
+            analysisCache.erase("typed-graph", reachGraphLayout());
+        }
+    }
+
+    void displayCompressionReport()
+    {
+        publishSnapshot();
+        SnapshotGuard snapshot = pinSnapshot();
+        auto compressed = getCompressedGraph(snapshot.get());
+        if (compressed == nullptr)
+        {
+            return;
+        }
+
+        size_t edgeCount = snapshot->getEdgeCount();
+        size_t pointerBytes = edgeCount * (sizeof(Edge) + sizeof(Edge*) + 16);
+        size_t csrBytes = (snapshot->getVertexCount() + 1) * sizeof(uint32_t)
+            + edgeCount * (sizeof(uint32_t) + sizeof(double) + sizeof(uint8_t));
+        size_t compressedBytes = compressed->getMemoryBytes();
+        double perEdge = edgeCount > 0 ? static_cast<double>(compressedBytes) / edgeCount : 0.0;
+
+        cout << "Adjacency storage for " << edgeCount << " relationships:\n";
+        cout << "  Edge objects:        ~" << pointerBytes << " bytes\n";
+        cout << "  CSR snapshot (out):  ~" << csrBytes << " bytes\n";
+        cout << "  Compressed:           " << compressedBytes << " bytes (" << perEdge << " bytes per relationship)\n";
+        cout << "Compressed adjacency is " << (useCompressedAdjacency ? "used" : "not used")
+            << " for communication and betweenness centrality.\n";
+    }
+
+    void exportPartitions(const string& directory, uint32_t partitionCount)
+    {
+        publishSnapshot();
+        SnapshotGuard snapshot = pinSnapshot();
+        if (PartitionedGraph::buildFromSnapshot(snapshot.get(), directory, partitionCount))
+        {
+            cout << "Graph has been written as " << partitionCount << " partitions to " << directory << endl;
+        }
+        else
+        {
+            cerr << "Error: Could not write partitions to " << directory << endl;
+        }
+    }
+
+    void importPartitions(const string& graphFile, const string& directory, uint32_t partitionCount)
+    {
+        if (PartitionedGraph::buildFromGraphFile(graphFile, directory, partitionCount))
+        {
+            cout << "Graph file " << graphFile << " has been written as " << partitionCount << " partitions to " << directory << endl;
+        }
+        else
+        {
+            cerr << "Error: Could not write partitions to " << directory << endl;
+        }
+    }
+
+    void findDegreesOfSeparationOutOfCore(const string& directory, const string& sourceName)
+    {
+        PartitionedGraph graph;
+        uint32_t source;
+        if (!graph.open(directory))
+        {
+            return;
+        }
+        if (!graph.findVertex(sourceName, source))
+        {
+            cerr << "Error: Node not found.\n";
+            return;
+        }
+
+        vector<int32_t> distance = graph.breadthFirstSearch(source);
+        map<int32_t, uint32_t> perLevel;
+        for (int32_t d : distance)
+        {
+            if (d > 0)
+            {
+                ++perLevel[d];
+            }
+        }
+
+        cout << "Individuals reachable from " << sourceName << ":\n";
+        for (const auto& level : perLevel)
+        {
+            cout << "  " << level.first << " hop(s): " << level.second << "\n";
+        }
+    }
+
+    void rankByPageRankOutOfCore(const string& directory, int iterations, size_t topCount)
+    {
+        PartitionedGraph graph;
+        if (!graph.open(directory))
+        {
+            return;
+        }
+
+        vector<double> rank = graph.pageRank(iterations);
+        vector<uint32_t> order;
+        for (uint32_t v = 0; v < graph.getVertexCount(); ++v)
+        {
+            if (!graph.getName(v).empty())
+            {
+                order.push_back(v);
+            }
+        }
+        size_t shown = min(topCount, order.size());
+        partial_sort(order.begin(), order.begin() + shown, order.end(),
+            [&rank](uint32_t a, uint32_t b) { return rank[a] > rank[b]; });
+
+        cout << "Most influential individuals by PageRank:\n";
+        for (size_t i = 0; i < shown; ++i)
+        {
+            cout << graph.getName(order[i]) << " (PageRank: " << rank[order[i]] << ")\n";
+        }
+    }
+
+    void findHighestCentralityDistributed(uint32_t workerCount, PartitioningScheme scheme)
+    {
+        publishSnapshot();
+        SnapshotGuard snapshot = pinSnapshot();
+        PartitionedWorkerPool pool;
+        if (!pool.start(snapshot.get(), workerCount, scheme))
+        {
+            return;
+        }
+
+        vector<double> centrality = pool.communicationCentrality();
+        int best = -1;
+        for (uint32_t v = 0; v < centrality.size(); ++v)
+        {
+            if (snapshot->isPresent(v) && (best < 0 || centrality[v] > centrality[best]))
+            {
+                best = static_cast<int>(v);
+            }
+        }
+
+        if (best < 0)
+        {
+            cout << "The network has no individuals.\n";
+            return;
+        }
+
+        cout << "Individual with the highest communication centrality: "
+            << snapshot->getName(best)
+            << " (Centrality: " << centrality[best] << ")\n";
+    }
+
+    void rankByPageRankDistributed(uint32_t workerCount, PartitioningScheme scheme, int iterations, size_t topCount)
+    {
+        publishSnapshot();
+        SnapshotGuard snapshot = pinSnapshot();
+        PartitionedWorkerPool pool;
+        if (!pool.start(snapshot.get(), workerCount, scheme))
+        {
+            return;
+        }
+
+        vector<double> rank = pool.pageRank(iterations);
+        vector<uint32_t> order;
+        for (uint32_t v = 0; v < rank.size(); ++v)
+        {
+            if (snapshot->isPresent(v))
+            {
+                order.push_back(v);
+            }
+        }
+        size_t shown = min(topCount, order.size());
+        partial_sort(order.begin(), order.begin() + shown, order.end(),
+            [&rank](uint32_t a, uint32_t b) { return rank[a] > rank[b]; });
+
+        cout << "Most influential individuals by PageRank:\n";
+        for (size_t i = 0; i < shown; ++i)
+        {
+            cout << snapshot->getName(order[i]) << " (PageRank: " << rank[order[i]] << ")\n";
+        }
+    }
+
+    // Keeps a landmark table of the given size for weighted queries; 0 disables it.
+    void setLandmarkCount(uint32_t count)
+    {
+        landmarkCount = count;
+        if (count == 0)
+        {
+            atomic_store(&landmarkIndex, shared_ptr<const LandmarkIndex>());
+        }
+        refreshLandmarkIndex();
+    }
+
+    // Blocks until a background rebuild of the landmark table, if any, has finished.
+    void waitForLandmarkIndex()
+    {
+        if (landmarkThread.joinable())
+        {
+            landmarkThread.join();
+        }
+    }
+
+    // Starts a background rebuild of the landmark table when it is older than the
+    // published snapshot. Queries keep using plain Dijkstra until it is current.
+    void refreshLandmarkIndex()
+    {
+        if (landmarkCount == 0 || landmarkBuildRunning.load())
+        {
+            return;
+        }
+        shared_ptr<const LandmarkIndex> current = atomic_load(&landmarkIndex);
+        if (current != nullptr && current->getVersion() == modificationCounter && current->getLandmarkCount() > 0
+            && current->getLandmarkCount() >= min<size_t>(landmarkCount, nodeIds.size()))
+        {
+            return;
+        }
+        if (landmarkThread.joinable())
+        {
+            landmarkThread.join();
+        }
+
+        landmarkBuildRunning = true;
+        uint32_t count = landmarkCount;
+        landmarkThread = thread([this, count]()
+            {
+                SnapshotGuard snapshot = pinSnapshot();
+                auto index = make_shared<const LandmarkIndex>(LandmarkIndex::build(snapshot.get(), count));
+                atomic_store(&landmarkIndex, index);
+                landmarkBuildRunning = false;
+            });
+    }
+
+    void findDegreesOfSeparation(const string& sourceName, const string& targetName, ReportData* data = nullptr)
+    {
+        publishSnapshot();
+        SnapshotGuard snapshot = pinSnapshot();
+        uint32_t source, target;
+        if (!snapshot->findVertex(sourceName, source) || !snapshot->findVertex(targetName, target))
+        {
+            cerr << "Error: Node not found.\n";
+            return;
+        }
+
+        auto started = chrono::steady_clock::now();
+        int32_t hops = pathQueries.hops(snapshot.get(), source, target);
+        auto hopsDone = chrono::steady_clock::now();
+
+        shared_ptr<const LandmarkIndex> index = atomic_load(&landmarkIndex);
+        bool indexCurrent = index != nullptr && index->getVersion() == snapshot->getVersion();
+        bool negative = false;
+        double distance = pathQueries.weightedDistance(snapshot.get(), source, target,
+            indexCurrent ? index.get() : nullptr, negative);
+        auto weightedDone = chrono::steady_clock::now();
+        refreshLandmarkIndex();
+        if (data != nullptr)
+        {
+            data->values.push_back({ "hops", hops });
+            if (hops >= 0 && !negative)
+            {
+                data->values.push_back({ "weightedDistance", distance });
+            }
+        }
+
+        if (hops < 0)
+        {
+            cout << targetName << " is not reachable from " << sourceName << ".\n";
+            return;
+        }
+        cout << "Degrees of separation between " << sourceName << " and " << targetName << ": " << hops
+            << " (" << chrono::duration_cast<chrono::microseconds>(hopsDone - started).count() << " us)\n";
+        if (negative)
+        {
+            cout << "Weighted distance is undefined: the search met a negative relationship weight.\n";
+        }
+        else
+        {
+            cout << "Weighted distance: " << distance << " ("
+                << chrono::duration_cast<chrono::microseconds>(weightedDone - hopsDone).count() << " us, "
+                << (indexCurrent ? to_string(index->getLandmarkCount()) + " landmarks" : string("no current landmark table"))
+                << ")\n";
+        }
+    }
+
+    void buildDistanceOracle()
+    {
+        publishSnapshot();
+        SnapshotGuard snapshot = pinSnapshot();
+        if (!distanceOracle.build(snapshot.get()))
+        {
+            return;
+        }
+
+        size_t vertexCount = max<size_t>(1, nodeIds.size());
+        cout << "Distance oracle built in " << distanceOracle.getBuildSeconds() << " s: "
+            << distanceOracle.getLabelEntryCount() << " label entries ("
+            << static_cast<double>(distanceOracle.getLabelEntryCount()) / vertexCount << " per individual), "
+            << distanceOracle.getMemoryBytes() << " bytes\n";
+    }
+
+    // Loads the oracle stored next to graphFile if it was built from the current graph.
+    void loadDistanceOracle(const string& graphFile)
+    {
+        publishSnapshot();
+        SnapshotGuard snapshot = pinSnapshot();
+        if (!distanceOracle.load(graphFile + ".pll", GraphFingerprint::of(snapshot.get())))
+        {
+            cerr << "Error: Could not load distance oracle from " << graphFile << ".pll\n";
+            return;
+        }
+        distanceOracle.setVersion(modificationCounter);
+        cout << "Distance oracle loaded: " << distanceOracle.getLabelEntryCount() << " label entries, "
+            << distanceOracle.getMemoryBytes() << " bytes\n";
+    }
+
+    // Returns the hop distance for every pair, -1 for unconnected pairs and -2 for unknown names.
+    vector<int32_t> queryDistanceOracle(const vector<pair<string, string>>& pairs)
+    {
+        vector<int32_t> results;
+        results.reserve(pairs.size());
+        for (const auto& namePair : pairs)
+        {
+            uint32_t u, v;
+            bool known = distanceOracle.findVertex(namePair.first, u) && distanceOracle.findVertex(namePair.second, v);
+            results.push_back(known ? distanceOracle.query(u, v) : -2);
+        }
+        return results;
+    }
+
+    void displayOracleDistance(const string& sourceName, const string& targetName)
+    {
+        if (!distanceOracle.isBuilt())
+        {
+            cerr << "Error: The distance oracle has not been built.\n";
+            return;
+        }
+        if (distanceOracle.getVersion() != modificationCounter)
+        {
+            cout << "Warning: The graph changed since the distance oracle was built.\n";
+        }
+
+        int32_t distance = queryDistanceOracle({ { sourceName, targetName } })[0];
+        if (distance == -2)
+        {
+            cerr << "Error: Node not found.\n";
+        }
+        else if (distance < 0)
+        {
+            cout << targetName << " is not reachable from " << sourceName << ".\n";
+        }
+        else
+        {
+            cout << "Distance between " << sourceName << " and " << targetName << ": " << distance << " hop(s)\n";
+        }
+    }
+
+    // Restricts the windowed analyses to relationships valid between the two
+    // "YYYY-MM-DD" dates, end exclusive; an empty date leaves that side open.
+    bool setTimeWindow(const string& startDate, const string& endDate)
+    {
+        Timestamp start = TIME_MIN;
+        Timestamp end = TIME_MAX;
+        if ((!startDate.empty() && !parseDate(startDate, start)) || (!endDate.empty() && !parseDate(endDate, end)))
+        {
+            cerr << "Error: Dates must be given as YYYY-MM-DD.\n";
+            return false;
+        }
+        if (start >= end)
+        {
+            cerr << "Error: The window must start before it ends.\n";
+            return false;
+        }
+        timeWindow.setWindow(start, end);
+        return true;
+    }
+
+    vector<string> getNamesById() const
+    {
+        vector<string> names(nextNodeId);
+        for (const auto& idPair : nodeIds)
+        {
+            names[idPair.second] = idPair.first;
+        }
+        return names;
+    }
+
+    void displayWindowReport(size_t topCount = 5)
+    {
+        vector<string> names = getNamesById();
+        string start = formatDate(timeWindow.getStart());
+        string end = formatDate(timeWindow.getEnd());
+        cout << "Window: " << (start.empty() ? "beginning" : start) << " to " << (end.empty() ? "now" : end) << "\n";
+        cout << "Relationships valid in the window: " << timeWindow.getActiveEdgeCount() << "\n";
+
+        const vector<uint32_t>& degree = timeWindow.getDegrees();
+        vector<uint32_t> ranked;
+        for (uint32_t v = 0; v < degree.size(); ++v)
         {
-            attendance.erase(name);
-            delete* it;
-            events.erase(it);
+            if (degree[v] > 0)
+            {
+                ranked.push_back(v);
+            }
         }
-        else
+        size_t shown = min(topCount, ranked.size());
+        partial_sort(ranked.begin(), ranked.begin() + shown, ranked.end(),
+            [&degree](uint32_t a, uint32_t b) { return degree[a] > degree[b] || (degree[a] == degree[b] && a < b); });
+        cout << "Most connected individuals in the window:\n";
+        for (size_t i = 0; i < shown; ++i)
         {
-            cerr << "Error: Event with name '" << name << "' not found.\n";
+            cout << names[ranked[i]] << " (Degree: " << degree[ranked[i]] << ")\n";
         }
 
+        vector<uint32_t> communities = timeWindow.getCommunities();
+        unordered_map<uint32_t, size_t> communitySize;
+        for (uint32_t v : ranked)
+        {
+            ++communitySize[communities[v]];
+        }
+        size_t largest = 0;
+        for (const auto& sizePair : communitySize)
+        {
+            largest = max(largest, sizePair.second);
+        }
+        cout << "Communities with relationships in the window: " << communitySize.size()
+            << " (largest has " << largest << " individuals)\n";
 
+        size_t eventCount = 0;
+        for (const auto& event : events)
+        {
+            if (event->getDay() != TIME_MIN && event->getDay() >= timeWindow.getStart() && event->getDay() < timeWindow.getEnd())
+            {
+                ++eventCount;
+            }
+        }
+        cout << "Events in the window: " << eventCount << "\n";
+        timeWindow.displayStatistics();
     }
 
-    void markAttendance(const string& eventName, const string& attendeeName) {
+    void findReachableInWindow(const string& sourceName)
+    {
+        auto it = nodeIds.find(sourceName);
+        if (it == nodeIds.end())
+        {
+            cerr << "Error: Node not found.\n";
+            return;
+        }
+
+        vector<string> names = getNamesById();
+        const vector<char>& reached = timeWindow.getReach(it->second);
+        vector<string> reachable;
+        for (uint32_t v = 0; v < reached.size(); ++v)
+        {
+            if (reached[v] && v != it->second)
+            {
+                reachable.push_back(names[v]);
+            }
+        }
+        cout << reachable.size() << " individual(s) reachable from " << sourceName << " in the window: ";
+        for (const auto& name : reachable)
+        {
+            cout << name << " ";
+        }
+        cout << endl;
+    }
 
+    // Earliest-arrival path that only follows relationships in the order in which
+    // they were valid.
+    void findTemporalPath(const string& sourceName, const string& targetName)
+    {
+        auto source = nodeIds.find(sourceName);
+        auto target = nodeIds.find(targetName);
+        if (source == nodeIds.end() || target == nodeIds.end())
+        {
+            cerr << "Error: Node not found.\n";
+            return;
+        }
 
-        if (attendance.find(eventName) == attendance.end() || nodes.find(attendeeName) == nodes.end())
+        vector<uint32_t> predecessor;
+        vector<Timestamp> arrival = timeWindow.getEarliestArrival(source->second, predecessor);
+        if (target->second >= arrival.size() || arrival[target->second] == TIME_MAX)
         {
-            cerr << "Error: Event or node not found while marking attendance.\n";
+            cout << "No time-respecting path from " << sourceName << " to " << targetName << " in the window.\n";
             return;
         }
 
-        attendance[eventName].push_back(attendeeName);
+        vector<string> names = getNamesById();
+        vector<uint32_t> path;
+        for (uint32_t v = target->second; v != NO_COMPONENT; v = predecessor[v])
+        {
+            path.push_back(v);
+        }
+        cout << "Earliest arrival at " << targetName << ": "
+            << (arrival[target->second] == TIME_MIN ? "always reachable" : formatDate(arrival[target->second])) << "\n";
+        cout << "Path: ";
+        for (auto it = path.rbegin(); it != path.rend(); ++it)
+        {
+            string day = formatDate(arrival[*it]);
+            cout << names[*it] << (day.empty() ? "" : " (" + day + ")") << " ";
+        }
+        cout << endl;
     }
 
-    void displayEventDetails(const string& eventName) {
-        auto it = find_if(events.begin(), events.end(), [&eventName](const Event* event) {
-            return event->getName() == eventName;
-            });
+    shared_ptr<const LinkPredictor> getLinkPredictor(const GraphSnapshot& graph)
+    {
+        return analysisCache.getOrCompute<LinkPredictor>("link-predictor", "", graph.getVersion(),
+            [&graph]() { return LinkPredictor(graph); });
+    }
 
-        if (it != events.end())
+    static void writeCandidates(const GraphSnapshot& graph, const vector<LinkCandidate>& candidates, ostream& out)
+    {
+        for (size_t i = 0; i < candidates.size(); ++i)
         {
-            cout << "Event: " << (*it)->getName() << ", Date: " << (*it)->getDate() << "\n";
-            cout << "Attendance: ";
-            for (const auto& attendee : attendance[(*it)->getName()]) {
-                cout << attendee << " ";
+            out << (i == 0 ? "" : ", ") << graph.getName(candidates[i].vertex);
+        }
+        out << "\n";
+    }
+
+    void reportRecommendations(const GraphSnapshot& graph, const string& name, size_t topCount, double budgetMilliseconds,
+        ostream& out, ReportData* data = nullptr)
+    {
+        uint32_t target;
+        if (!graph.findVertex(name, target) || !graph.isPresent(target))
+        {
+            cerr << "Error: Node not found.\n";
+            return;
+        }
+
+        auto start = chrono::steady_clock::now();
+        auto predictor = getLinkPredictor(graph);
+        auto built = chrono::steady_clock::now();
+        LinkRecommendations result = predictor->recommend(graph, target, topCount,
+            chrono::microseconds(static_cast<int64_t>(budgetMilliseconds * 1000)));
+        auto ms = [](chrono::steady_clock::duration d) { return chrono::duration<double, milli>(d).count(); };
+        if (data != nullptr)
+        {
+            for (const auto* list : { &result.friendsOfFriends, &result.randomWalks })
+            {
+                vector<pair<string, double>> ranked;
+                for (const LinkCandidate& candidate : *list)
+                {
+                    ranked.push_back({ graph.getName(candidate.vertex), candidate.score });
+                }
+                data->rankings.push_back({ list == &result.friendsOfFriends ? "friendsOfFriends" : "randomWalks", ranked });
             }
+            data->values.push_back({ "complete", result.complete ? 1 : 0 });
+        }
 
-            cout << "\n";
+        out << "People " << name << " may know (" << fixed << setprecision(2) << ms(chrono::steady_clock::now() - built)
+            << " ms" << (result.complete ? "" : ", budget reached") << "; predictor ready in " << ms(built - start) << " ms):\n";
+        out << "Friends of friends:\n";
+        for (const LinkCandidate& candidate : result.friendsOfFriends)
+        {
+            out << "  " << graph.getName(candidate.vertex) << " - mutual: " << candidate.commonNeighbors
+                << ", Adamic-Adar: " << setprecision(3) << candidate.adamicAdar << ", Jaccard: " << candidate.jaccard << "\n";
+        }
+        out << "Random walks (" << result.walks << " walks):\n";
+        for (const LinkCandidate& candidate : result.randomWalks)
+        {
+            out << "  " << graph.getName(candidate.vertex) << " - personalized PageRank: " << setprecision(4)
+                << candidate.score << ", mutual: " << candidate.commonNeighbors << "\n";
+        }
+        out.unsetf(ios::fixed);
+        out << setprecision(6);
+    }
+
+    // Recommends for every member in parallel; each member gets its own budget and
+    // the lines are written in member order once all of them are done.
+    void reportRecommendationsForMembers(const GraphSnapshot& graph, const vector<uint32_t>& members, size_t topCount,
+        double budgetMilliseconds, ostream& out, JobControl* control = nullptr)
+    {
+        auto start = chrono::steady_clock::now();
+        auto predictor = getLinkPredictor(graph);
+        vector<string> lines(members.size());
+        atomic<uint32_t> partial{ 0 };
+        if (control != nullptr)
+        {
+            control->setTotal(members.size());
+        }
+
+        TaskScheduler& scheduler = TaskScheduler::instance();
+        uint32_t memberCount = static_cast<uint32_t>(members.size());
+        scheduler.parallelFor(memberCount, max<uint32_t>(1, scheduler.grainFor(memberCount) / 4),
+            [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t i = begin; i < end; ++i)
+                {
+                    if (control != nullptr && control->isCancelled())
+                    {
+                        return;
+                    }
+                    uint32_t target = members[i];
+                    if (target >= graph.getVertexCount() || !graph.isPresent(target))
+                    {
+                        continue;
+                    }
+                    LinkRecommendations result = predictor->recommend(graph, target, topCount,
+                        chrono::microseconds(static_cast<int64_t>(budgetMilliseconds * 1000)));
+                    partial += !result.complete;
+
+                    ostringstream line;
+                    line << graph.getName(target) << ": friends of friends: ";
+                    writeCandidates(graph, result.friendsOfFriends, line);
+                    line << "  random walks: ";
+                    writeCandidates(graph, result.randomWalks, line);
+                    lines[i] = line.str();
+                    if (control != nullptr)
+                    {
+                        control->advance();
+                    }
+                }
+            });
+        if (control != nullptr && control->isCancelled())
+        {
+            return;
+        }
+
+        for (const string& line : lines)
+        {
+            out << line;
         }
+        out << "Scored " << members.size() << " member(s) in "
+            << chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count() << " ms; "
+            << partial.load() << " stopped at the time budget.\n";
+    }
+
+    // Suggests new friendship or collaboration partners for name from friends of
+    // friends and from personalized PageRank, within budgetMilliseconds.
+    void recommendConnections(const string& name, size_t topCount = 5, double budgetMilliseconds = 50.0,
+        ReportData* data = nullptr)
+    {
+        publishSnapshot();
+        SnapshotGuard snapshot = pinSnapshot();
+        reportRecommendations(snapshot.get(), name, topCount, budgetMilliseconds, cout, data);
+    }
+
+    void recommendConnectionsForRole(const string& role, size_t topCount = 5, double budgetMilliseconds = 50.0)
+    {
+        publishSnapshot();
+        SnapshotGuard snapshot = pinSnapshot();
+        reportRecommendationsForMembers(snapshot.get(), attributes.select(role, ""), topCount, budgetMilliseconds, cout);
+    }
 
+    // Runs one of the snapshot reports as a background job on the current graph.
+    // analysis is "centrality", "communities", "betweenness", "negative-paths"
+    // (argument is the source), "components" or "recommendations" (argument is the
+    // role to recommend for, Student by default). Returns 0 for unknown analyses.
+    uint64_t submitAnalysisJob(const string& analysis, const string& argument = "")
+    {
+        using Report = function<void(const GraphSnapshot&, ostream&, JobControl&)>;
+        Report report;
+        if (analysis == "centrality")
+        {
+            report = [this](const GraphSnapshot& graph, ostream& out, JobControl& control) { reportHighestCentrality(graph, out, &control); };
+        }
+        else if (analysis == "communities")
+        {
+            report = [this](const GraphSnapshot& graph, ostream& out, JobControl& control) { reportCollaborationNetworks(graph, out, &control); };
+        }
+        else if (analysis == "betweenness")
+        {
+            report = [this](const GraphSnapshot& graph, ostream& out, JobControl& control) { reportBetweennessCentrality(graph, out, &control); };
+        }
+        else if (analysis == "negative-paths")
+        {
+            report = [this, argument](const GraphSnapshot& graph, ostream& out, JobControl& control) { reportNegativeInfluencePaths(graph, argument, out, &control); };
+        }
+        else if (analysis == "components")
+        {
+            report = [this](const GraphSnapshot& graph, ostream& out, JobControl& control) { reportConnectedComponents(graph, out, &control); };
+        }
+        else if (analysis == "recommendations")
+        {
+            vector<uint32_t> members = attributes.select(argument.empty() ? "Student" : argument, "");
+            report = [this, members](const GraphSnapshot& graph, ostream& out, JobControl& control) { reportRecommendationsForMembers(graph, members, 5, 50.0, out, &control); };
+        }
         else
         {
-            cerr << "Error: Event not found.\n";
+            cerr << "Error: Unknown analysis.\n";
+            return 0;
         }
 
+        publishSnapshot();
+        cacheDynamicCentrality(*publishedSnapshot.load());
+        // Every queued or running job pins a snapshot; refuse new jobs rather than
+        // block the writer while all reader slots stay taken.
+        auto snapshot = make_shared<SnapshotGuard>(epochs, publishedSnapshot, chrono::seconds(1));
+        if (!snapshot->isPinned())
+        {
+            cerr << "Error: Too many analyses are holding snapshots; wait for running jobs to finish.\n";
+            return 0;
+        }
+        string name = argument.empty() ? analysis : analysis + " " + argument;
+        return backgroundJobs.submit(name, [snapshot, report](ostream& out, JobControl& control)
+            {
+                report(snapshot->get(), out, control);
+            });
+    }
 
+    void displayJobs() const
+    {
+        backgroundJobs.display(cout);
     }
 
-    void storeGraphDetailsToFile(const string& filename) {
-        ofstream outFile(filename);
+    bool cancelJob(uint64_t id)
+    {
+        return backgroundJobs.cancel(id);
+    }
+
+    bool waitForJob(uint64_t id)
+    {
+        return backgroundJobs.wait(id);
+    }
+
+    void displayJobResult(uint64_t id, ostream& out = cout) const
+    {
+        backgroundJobs.displayResult(id, out);
+    }
+
+    void setAnalysisCacheBudget(size_t bytes)
+    {
+        analysisCache.setMemoryBudget(bytes);
+    }
+
+    void displayAnalysisCacheStatistics()
+    {
+        analysisCache.displayStatistics();
+    }
+
+    ~SocialNetwork() {
+        backgroundJobs.shutdown();
+        closePersistentStore();
+        if (landmarkThread.joinable())
+        {
+            landmarkThread.join();
+        }
+        delete publishedSnapshot.load();
+        delete dynamicCentrality;
+
+        for (auto& edge : edges) {
+            delete edge;
+        }
+        for (auto& event : events) {
+            delete event;
+        }
+    }
+};
+
+// Runs a command stream without prompts, one command per line. Fields are
+// separated by whitespace; fields containing spaces are written in double quotes
+// and '#' starts a comment. Consecutive mutations are applied as one batch, after
+// which the log is committed and snapshots and indexes are rebuilt once. Every
+// batch and every other command produces one JSON object per line on the output.
+class BatchRunner {
+
+private:
+    SocialNetwork& network;
+    ostream& out;
+    vector<MutationRecord> pendingMutations;
+    vector<pair<size_t, string>> pendingSources;
+    size_t pendingFirstLine = 0;
+    vector<pair<size_t, string>> pendingErrors;
+    vector<uint64_t> submittedJobs;
+    size_t commandCount = 0;
+    size_t batchCount = 0;
+    size_t mutationCount = 0;
+    size_t errorCount = 0;
+
+    static bool tokenize(const string& line, vector<string>& tokens)
+    {
+        tokens.clear();
+        size_t pos = 0;
+        while (pos < line.size())
+        {
+            if (isspace(static_cast<unsigned char>(line[pos])))
+            {
+                ++pos;
+                continue;
+            }
+            if (line[pos] == '#')
+            {
+                break;
+            }
 
-        if (outFile.is_open()) {
-            outFile << "Nodes:\n";
-            for (const auto& nodePair : nodes)
+            string token;
+            if (line[pos] == '"')
             {
-                const Node* currentNode = nodePair.second;
-                outFile << currentNode->getName() << "," << currentNode->getRole() << ",";
-                const auto& interests = currentNode->getInterests();
-                for (size_t i = 0; i < interests.size(); ++i)
+                ++pos;
+                while (pos < line.size() && line[pos] != '"')
                 {
-                    outFile << interests[i];
-                    if (i != interests.size() - 1)
+                    if (line[pos] == '\\' && pos + 1 < line.size())
                     {
-                        outFile << ";";
+                        ++pos;
                     }
+                    token += line[pos++];
+                }
+                if (pos >= line.size())
+                {
+                    return false;
+                }
+                ++pos;
+            }
+            else
+            {
+                while (pos < line.size() && !isspace(static_cast<unsigned char>(line[pos])))
+                {
+                    token += line[pos++];
+                }
+            }
+            tokens.push_back(token);
+        }
+        return true;
+    }
+
+    static string escapeJson(const string& text)
+    {
+        string escaped;
+        for (char c : text)
+        {
+            switch (c)
+            {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            case '\r': escaped += "\\r"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    ostringstream code;
+                    code << "\\u" << hex << setw(4) << setfill('0') << static_cast<int>(c);
+                    escaped += code.str();
+                }
+                else
+                {
+                    escaped += c;
                 }
+            }
+        }
+        return escaped;
+    }
+
+    static string jsonLines(const string& text)
+    {
+        string array = "[";
+        size_t begin = 0;
+        bool first = true;
+        while (begin < text.size())
+        {
+            size_t end = text.find('\n', begin);
+            if (end == string::npos)
+            {
+                end = text.size();
+            }
+            array += (first ? "\"" : ",\"") + escapeJson(text.substr(begin, end - begin)) + "\"";
+            first = false;
+            begin = end + 1;
+        }
+        return array + "]";
+    }
+
+    static bool parseRelationshipType(const string& text, RelationshipType& type)
+    {
+        if (!text.empty() && all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; }))
+        {
+            errno = 0;
+            long value = strtol(text.c_str(), nullptr, 10);
+            if (errno == ERANGE || value >= NUM_RELATIONSHIPS)
+            {
+                return false;
+            }
+            type = static_cast<RelationshipType>(value);
+            return true;
+        }
+        for (int i = 0; i < NUM_RELATIONSHIPS; ++i)
+        {
+            string name = RelationshipNames[i];
+            bool equal = name.size() == text.size();
+            for (size_t c = 0; equal && c < name.size(); ++c)
+            {
+                char expected = name[c] == ' ' ? '_' : static_cast<char>(toupper(static_cast<unsigned char>(name[c])));
+                char actual = text[c] == ' ' ? '_' : static_cast<char>(toupper(static_cast<unsigned char>(text[c])));
+                equal = expected == actual;
+            }
+            if (equal)
+            {
+                type = static_cast<RelationshipType>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Translates a mutation command into a log record; returns an error message,
+    // or an empty string on success.
+    static string parseMutation(const vector<string>& tokens, MutationRecord& record)
+    {
+        const string& command = tokens[0];
+        size_t arguments = tokens.size() - 1;
+        record = MutationRecord();
+        if (command == "addNode" && arguments >= 2)
+        {
+            record.type = MUTATION_ADD_NODE;
+            record.strings.assign(tokens.begin() + 1, tokens.end());
+        }
+        else if (command == "addEdge" && arguments >= 4 && arguments <= 6)
+        {
+            RelationshipType type;
+            char* end = nullptr;
+            record.weight = strtod(tokens[3].c_str(), &end);
+            if (end == tokens[3].c_str() || *end != '\0')
+            {
+                return "invalid weight";
+            }
+            if (!parseRelationshipType(tokens[4], type))
+            {
+                return "unknown relationship type";
+            }
+            record.relationshipType = type;
+            record.strings = { tokens[1], tokens[2] };
+
+            Timestamp validFrom = TIME_MIN;
+            Timestamp validUntil = TIME_MAX;
+            if ((arguments >= 5 && tokens[5] != "-" && !parseDate(tokens[5], validFrom))
+                || (arguments == 6 && tokens[6] != "-" && !parseDate(tokens[6], validUntil)))
+            {
+                return "dates must be YYYY-MM-DD or -";
+            }
+            record.type = MUTATION_ADD_EDGE;
+            if (validFrom != TIME_MIN || validUntil != TIME_MAX)
+            {
+                record.type = MUTATION_ADD_TEMPORAL_EDGE;
+                record.strings.push_back(to_string(validFrom));
+                record.strings.push_back(to_string(validUntil));
+            }
+        }
+        else if (command == "removeNode" && arguments == 1)
+        {
+            record.type = MUTATION_REMOVE_NODE;
+            record.strings = { tokens[1] };
+        }
+        else if (command == "removeEdge" && arguments == 2)
+        {
+            record.type = MUTATION_REMOVE_EDGE;
+            record.strings = { tokens[1], tokens[2] };
+        }
+        else if (command == "addEvent" && arguments == 2)
+        {
+            record.type = MUTATION_ADD_EVENT;
+            record.strings = { tokens[1], tokens[2] };
+        }
+        else if (command == "removeEvent" && arguments == 1)
+        {
+            record.type = MUTATION_REMOVE_EVENT;
+            record.strings = { tokens[1] };
+        }
+        else if (command == "markAttendance" && arguments == 2)
+        {
+            record.type = MUTATION_MARK_ATTENDANCE;
+            record.strings = { tokens[1], tokens[2] };
+        }
+        else
+        {
+            return "wrong number of arguments";
+        }
+        return "";
+    }
+
+    static bool isMutation(const string& command)
+    {
+        return command == "addNode" || command == "addEdge" || command == "removeNode" || command == "removeEdge"
+            || command == "addEvent" || command == "removeEvent" || command == "markAttendance";
+    }
+
+    // Runs body with cout and cerr redirected into one buffer and returns what it printed.
+    static string capture(const function<void()>& body)
+    {
+        ostringstream buffer;
+        streambuf* previousOut = cout.rdbuf(buffer.rdbuf());
+        streambuf* previousErr = cerr.rdbuf(buffer.rdbuf());
+        body();
+        cout.rdbuf(previousOut);
+        cerr.rdbuf(previousErr);
+        return buffer.str();
+    }
+
+    static double millisecondsSince(chrono::steady_clock::time_point start)
+    {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    }
+
+    // Applies the pending mutations as one batch. A record that parsed but did not
+    // take effect, such as removing an unknown individual, is listed in errors.
+    void flushMutations()
+    {
+        if (pendingMutations.empty() && pendingErrors.empty())
+        {
+            return;
+        }
+
+        auto start = chrono::steady_clock::now();
+        vector<bool> applied;
+        string messages = capture([this, &applied]()
+            {
+                applied = network.applyMutations(pendingMutations);
+                network.commitMutations();
+                network.publishSnapshot();
+                network.refreshLandmarkIndex();
+            });
 
-                outFile << "\n";
+        size_t failed = 0;
+        for (size_t i = 0; i < applied.size(); ++i)
+        {
+            if (!applied[i])
+            {
+                ++failed;
+                pendingErrors.push_back({ pendingSources[i].first, pendingSources[i].second + ": not applied" });
+            }
+        }
+        errorCount += failed;
+        stable_sort(pendingErrors.begin(), pendingErrors.end(),
+            [](const pair<size_t, string>& a, const pair<size_t, string>& b) { return a.first < b.first; });
+
+        ++batchCount;
+        mutationCount += pendingMutations.size();
+        out << "{\"line\":" << pendingFirstLine << ",\"command\":\"batch\",\"status\":\""
+            << (pendingErrors.empty() ? "ok" : "error") << "\",\"mutations\":" << pendingMutations.size()
+            << ",\"applied\":" << pendingMutations.size() - failed
+            << ",\"elapsedMs\":" << millisecondsSince(start) << ",\"output\":" << jsonLines(messages);
+        if (!pendingErrors.empty())
+        {
+            out << ",\"errors\":[";
+            for (size_t i = 0; i < pendingErrors.size(); ++i)
+            {
+                out << (i == 0 ? "\"" : ",\"") << "line " << pendingErrors[i].first << ": "
+                    << escapeJson(pendingErrors[i].second) << "\"";
             }
+            out << "]";
+        }
+        out << "}\n";
+        pendingMutations.clear();
+        pendingSources.clear();
+        pendingErrors.clear();
+    }
 
-            outFile << "\nEdges:\n";
-            for (const auto& edge : edges)
+    // Renders a report's data as a "result" object with one field per ranking,
+    // list, grouping and value.
+    static string jsonResult(const ReportData& data)
+    {
+        ostringstream json;
+        json << setprecision(10) << ",\"result\":{";
+        bool first = true;
+        auto key = [&json, &first](const string& name)
+        {
+            json << (first ? "\"" : ",\"") << escapeJson(name) << "\":";
+            first = false;
+        };
+        for (const auto& ranking : data.rankings)
+        {
+            key(ranking.first);
+            json << "[";
+            for (size_t i = 0; i < ranking.second.size(); ++i)
             {
-                outFile << edge->getSource()->getName() << ","
-                    << edge->getDestination()->getName() << ","
-                    << edge->getWeight() << ","
-                    << static_cast<int>(edge->getRelationshipType()) << "\n";
+                json << (i == 0 ? "" : ",") << "{\"name\":\"" << escapeJson(ranking.second[i].first)
+                    << "\",\"score\":" << ranking.second[i].second << "}";
             }
-
-            outFile << "\nEvents:\n";
-            for (const auto& event : events)
+            json << "]";
+        }
+        for (const auto& list : data.lists)
+        {
+            key(list.first);
+            json << "[";
+            for (size_t i = 0; i < list.second.size(); ++i)
             {
-                outFile << event->getName() << "," << event->getDate() << "\n";
+                json << (i == 0 ? "\"" : ",\"") << escapeJson(list.second[i]) << "\"";
             }
-
-            outFile << "\nAttendance:\n";
-            for (const auto& attendancePair : attendance)
+            json << "]";
+        }
+        for (const auto& grouping : data.groupings)
+        {
+            key(grouping.first);
+            json << "[";
+            for (size_t i = 0; i < grouping.second.size(); ++i)
             {
-                outFile << attendancePair.first << ",";
-                const auto& attendees = attendancePair.second;
-                for (size_t i = 0; i < attendees.size(); ++i)
+                json << (i == 0 ? "[" : ",[");
+                for (size_t j = 0; j < grouping.second[i].size(); ++j)
                 {
-                    outFile << attendees[i];
-                    if (i != attendees.size() - 1)
-                    {
-                        outFile << ";";
-                    }
+                    json << (j == 0 ? "\"" : ",\"") << escapeJson(grouping.second[i][j]) << "\"";
                 }
-
-                outFile << "\n";
+                json << "]";
             }
-
-            outFile.close();
-            cout << "Graph details have been stored in the file: " << filename << endl;
+            json << "]";
         }
-        else
+        for (const auto& value : data.values)
         {
-            cerr << "Unable to open file: " << filename << endl;
+            key(value.first);
+            json << value.second;
         }
+        json << "}";
+        return json.str();
     }
 
-    void detectNegativeInfluencePaths(const string& source)
+    void report(size_t lineNumber, const string& command, bool ok, double elapsedMs, const string& output,
+        const string& extra = "")
     {
-        unordered_map<string, double> distance;
-        unordered_map<string, string> predecessor;
-
-        for (const auto& nodePair : nodes) {
-            distance[nodePair.first] = numeric_limits<double>::infinity();
-            predecessor[nodePair.first] = "";
+        if (!ok)
+        {
+            ++errorCount;
         }
+        out << "{\"line\":" << lineNumber << ",\"command\":\"" << escapeJson(command) << "\",\"status\":\""
+            << (ok ? "ok" : "error") << "\",\"elapsedMs\":" << elapsedMs << extra
+            << ",\"output\":" << jsonLines(output) << "}\n";
+    }
 
-        distance[source] = 0.0;
-        for (size_t i = 0; i < nodes.size() - 1; ++i)
+    // Executes a non-mutation command; returns false when it is unknown or malformed.
+    bool runCommand(const vector<string>& tokens, string& extra)
+    {
+        const string& command = tokens[0];
+        size_t arguments = tokens.size() - 1;
+        auto argument = [&tokens](size_t i) { return tokens[i]; };
+
+        ReportData data;
+        if (command == "nodes" && arguments == 0) network.displayAllNodes();
+        else if (command == "node" && arguments == 1) network.displayNodeDetails(argument(1));
+        else if (command == "graph" && arguments == 0) network.visualizeGraph();
+        else if (command == "centrality" && arguments == 0) network.findHighestCentrality(&data);
+        else if (command == "cacheStats" && arguments == 0) network.displayAnalysisCacheStatistics();
+        else if (command == "cacheBudget" && arguments == 1) network.setAnalysisCacheBudget(stoull(argument(1)));
+        else if (command == "communities" && arguments == 0) network.identifyCollaborationNetworks(&data);
+        else if (command == "degree" && arguments == 0) network.determineInfluentialByDegreeCentrality(&data);
+        else if (command == "betweenness" && arguments == 0) network.determineInfluentialByBetweennessCentrality(&data);
+        else if (command == "clusters" && arguments == 0) network.identifySocialClusters(&data);
+        else if (command == "components" && arguments == 0) network.displayConnectedComponents(&data);
+        else if (command == "event" && arguments == 1) network.displayEventDetails(argument(1));
+        else if (command == "negativePaths" && arguments == 1) network.detectNegativeInfluencePaths(argument(1));
+        else if (command == "mst" && arguments == 1) network.findMinimumSpanningTree(argument(1));
+        else if (command == "separation" && arguments == 2) network.findDegreesOfSeparation(argument(1), argument(2), &data);
+        else if (command == "landmarks" && arguments == 1)
         {
-            for (const auto& edge : edges)
+            network.setLandmarkCount(stoul(argument(1)));
+            network.waitForLandmarkIndex();
+        }
+        else if (command == "filter" && arguments == 2) network.findMembersByAttributes(argument(1), argument(2), &data);
+        else if (command == "attributeReport" && arguments == 0) network.displayAttributeStorageReport();
+        else if (command == "compression" && arguments == 1 && (argument(1) == "on" || argument(1) == "off"))
+        {
+            network.setCompressedAdjacency(argument(1) == "on");
+        }
+        else if (command == "compressionReport" && arguments == 0) network.displayCompressionReport();
+        else if (command == "dynamic" && arguments == 1 && (argument(1) == "on" || argument(1) == "off"))
+        {
+            if (argument(1) == "on")
             {
-                const string& u = edge->getSource()->getName();
-                const string& v = edge->getDestination()->getName();
-                double weight = edge->getWeight();
-
-                if (distance[u] + weight < distance[v])
-                {
-                    distance[v] = distance[u] + weight;
-                    predecessor[v] = u;
-                }
+                network.enableDynamicCentrality();
+            }
+            else
+            {
+                network.disableDynamicCentrality();
             }
         }
-        for (const auto& edge : edges)
+        else if (command == "dynamic" && arguments == 1 && argument(1) == "report") network.displayDynamicCentrality();
+        else if (command == "dynamic" && arguments == 1 && argument(1) == "verify") network.verifyDynamicCentrality();
+        else if (command == "dynamic" && arguments == 2 && argument(1) == "verifyUpdates" && (argument(2) == "on" || argument(2) == "off"))
         {
-            const string& u = edge->getSource()->getName();
-            const string& v = edge->getDestination()->getName();
-            double weight = edge->getWeight();
-
-            if (distance[u] + weight < distance[v])
+            network.setDynamicCentralityVerification(argument(2) == "on");
+        }
+        else if ((command == "recommend" || command == "recommendRole") && arguments >= 1 && arguments <= 3)
+        {
+            size_t topCount = arguments >= 2 ? stoul(argument(2)) : 5;
+            double budget = arguments == 3 ? stod(argument(3)) : 50.0;
+            if (command == "recommend")
             {
-                cout << "Negative influence path detected from " << source << " to " << v << ".\n";
-
-                vector<string> cycle;
-                string current = v;
-                while (current != "")
-                {
-                    cycle.push_back(current);
-                    current = predecessor[current];
-                    if (current == v)
-                    {
-                        cycle.push_back(current);
-                        break;
-                    }
-                }
-
-
-                cout << "Cycle: ";
-                for (auto it = cycle.rbegin(); it != cycle.rend(); ++it)
+                network.recommendConnections(argument(1), topCount, budget, &data);
+            }
+            else
+            {
+                network.recommendConnectionsForRole(argument(1), topCount, budget);
+            }
+        }
+        else if (command == "window" && arguments == 2)
+        {
+            return network.setTimeWindow(argument(1) == "-" ? "" : argument(1), argument(2) == "-" ? "" : argument(2));
+        }
+        else if (command == "windowReport" && arguments == 0) network.displayWindowReport();
+        else if (command == "reachable" && arguments == 1) network.findReachableInWindow(argument(1));
+        else if (command == "temporalPath" && arguments == 2) network.findTemporalPath(argument(1), argument(2));
+        else if (command == "store" && arguments == 1) network.storeGraphDetailsToFile(argument(1));
+        else if (command == "load" && arguments == 1) network.loadGraphDetailsFromFile(argument(1));
+        else if (command == "open" && arguments == 1) network.openPersistentStore(argument(1));
+        else if (command == "compact" && arguments == 0) network.compactMutationLog();
+        else if (command == "partition" && arguments == 2) network.exportPartitions(argument(1), stoul(argument(2)));
+        else if (command == "partitionFile" && arguments == 3) network.importPartitions(argument(1), argument(2), stoul(argument(3)));
+        else if (command == "outOfCoreSeparation" && arguments == 2) network.findDegreesOfSeparationOutOfCore(argument(1), argument(2));
+        else if (command == "outOfCorePageRank" && arguments == 2) network.rankByPageRankOutOfCore(argument(1), stoi(argument(2)), 10);
+        else if (command == "distributedCentrality" && arguments == 2)
+        {
+            network.findHighestCentralityDistributed(stoul(argument(1)), argument(2) == "2d" ? PARTITION_2D : PARTITION_1D);
+        }
+        else if (command == "distributedPageRank" && arguments == 3)
+        {
+            network.rankByPageRankDistributed(stoul(argument(1)), argument(2) == "2d" ? PARTITION_2D : PARTITION_1D, stoi(argument(3)), 10);
+        }
+        else if (command == "buildOracle" && arguments == 0) network.buildDistanceOracle();
+        else if (command == "oracle" && arguments == 2) network.displayOracleDistance(argument(1), argument(2));
+        else if (command == "submit" && (arguments == 1 || arguments == 2))
+        {
+            uint64_t id = network.submitAnalysisJob(argument(1), arguments == 2 ? argument(2) : "");
+            if (id == 0)
+            {
+                return false;
+            }
+            submittedJobs.push_back(id);
+            extra = ",\"job\":" + to_string(id);
+        }
+        else if (command == "wait" && arguments == 1)
+        {
+            if (argument(1) == "all")
+            {
+                for (uint64_t id : submittedJobs)
                 {
-                    cout << *it << " ";
+                    network.waitForJob(id);
                 }
-                cout << endl;
             }
-
+            else if (!network.waitForJob(stoull(argument(1))))
+            {
+                return false;
+            }
         }
-    }
-
-    void findMinimumSpanningTree(const string& startNode)
-    {
-        unordered_set<Node*> visited;
-        priority_queue<pair<double, Node*>, vector<pair<double, Node*>>, greater<>> pq;
-        unordered_map<Node*, Node*> parent;
+        else if (command == "result" && arguments == 1)
+        {
+            network.waitForJob(stoull(argument(1)));
+            network.displayJobResult(stoull(argument(1)));
+        }
+        else if (command == "jobs" && arguments == 0) network.displayJobs();
+        else return false;
 
-        if (nodes.find(startNode) == nodes.end())
+        if (!data.rankings.empty() || !data.lists.empty() || !data.groupings.empty() || !data.values.empty())
         {
-            cerr << "Error: Start node not found.\n";
-            return;
+            extra += jsonResult(data);
         }
+        return true;
+    }
 
-        Node* start = nodes[startNode];
-        pq.push({ 0.0, start });
+public:
+    BatchRunner(SocialNetwork& n, ostream& o)
+        : network(n), out(o) {}
 
-        while (!pq.empty())
+    void run(istream& in)
+    {
+        auto start = chrono::steady_clock::now();
+        streamsize precision = out.precision();
+        out << setprecision(6);
+        string line;
+        vector<string> tokens;
+        size_t lineNumber = 0;
+
+        while (getline(in, line))
         {
-            Node* current = pq.top().second;
-            double cost = pq.top().first;
-            pq.pop();
-
-            if (visited.find(current) != visited.end())
+            ++lineNumber;
+            if (!tokenize(line, tokens))
             {
+                flushMutations();
+                report(lineNumber, "", false, 0.0, "Error: Unterminated quote.");
                 continue;
             }
+            if (tokens.empty())
+            {
+                continue;
+            }
+            ++commandCount;
 
-            visited.insert(current);
-
-            for (const auto& edge : edges)
+            if (isMutation(tokens[0]))
             {
-                if (edge->getSource() == current || edge->getDestination() == current)
+                if (pendingMutations.empty() && pendingErrors.empty())
+                {
+                    pendingFirstLine = lineNumber;
+                }
+                MutationRecord record;
+                string error = parseMutation(tokens, record);
+                if (error.empty())
+                {
+                    pendingMutations.push_back(record);
+                    pendingSources.push_back({ lineNumber, tokens[0] });
+                }
+                else
+                {
+                    ++errorCount;
+                    pendingErrors.push_back({ lineNumber, tokens[0] + ": " + error });
+                }
+                continue;
+            }
+
+            flushMutations();
+            auto commandStart = chrono::steady_clock::now();
+            string extra;
+            bool ok = false;
+            bool invalidNumber = false;
+            string output = capture([&]()
                 {
-                    Node* neighbor = edge->getSource() == current ? edge->getDestination() : edge->getSource();
-                    if (visited.find(neighbor) == visited.end())
+                    try
                     {
-                        double edgeWeight = edge->getWeight();
-                        if (edgeWeight < cost || parent.find(neighbor) == parent.end())
-                        {
-                            pq.push({ edgeWeight, neighbor });
-                            parent[neighbor] = current;
-                        }
+                        ok = runCommand(tokens, extra);
                     }
-                }
+                    catch (const logic_error&)
+                    {
+                        invalidNumber = true;
+                    }
+                });
+            if (invalidNumber)
+            {
+                output += "Error: Invalid numeric argument.";
             }
-        }
-        cout << "Minimum Spanning Tree from " << startNode << ":\n";
-        for (const auto& p : parent)
-        {
-            if (p.second != nullptr) {
-                cout << "Edge: " << p.second->getName() << " - " << p.first->getName() << "\n";
+            else if (!ok && output.empty())
+            {
+                output = "Error: Unknown command or wrong number of arguments.";
             }
+            report(lineNumber, tokens[0], ok, millisecondsSince(commandStart), output, extra);
         }
+        flushMutations();
+
+        out << "{\"command\":\"summary\",\"commands\":" << commandCount << ",\"batches\":" << batchCount
+            << ",\"mutations\":" << mutationCount << ",\"errors\":" << errorCount
+            << ",\"elapsedMs\":" << millisecondsSince(start) << "}\n";
+        out << setprecision(precision);
     }
+};
 
-    ~SocialNetwork() {
-        for (auto& nodePair : nodes) {
-            delete nodePair.second;
-        }
+int main(int argc, char* argv[]) {
 
-        for (auto& edge : edges) {
-            delete edge;
+    if (argc == 2 && string(argv[1]) == PartitionedWorkerPool::WORKER_ARGUMENT)
+    {
+        return PartitionedWorkerPool::serveWorker();
+    }
+    PartitionedWorkerPool::setExecutablePath(argv[0]);
+
+    string batchInput;
+    string batchOutput;
+    for (int i = 1; i < argc; ++i)
+    {
+        string argument = argv[i];
+        if (argument == "--batch" && i + 1 < argc)
+        {
+            batchInput = argv[++i];
         }
-        for (auto& event : events) {
-            delete event;
+        else if (argument == "--output" && i + 1 < argc)
+        {
+            batchOutput = argv[++i];
+        }
+        else
+        {
+            cerr << "Usage: " << argv[0] << " [--batch <command file or -> [--output <file>]]\n";
+            return 1;
         }
     }
-};
 
-int main() {
+    if (!batchInput.empty())
+    {
+        SocialNetwork network;
+        ifstream inFile;
+        ofstream outFile;
+        if (batchInput != "-")
+        {
+            inFile.open(batchInput);
+            if (!inFile.is_open())
+            {
+                cerr << "Unable to open file: " << batchInput << endl;
+                return 1;
+            }
+        }
+        if (!batchOutput.empty())
+        {
+            outFile.open(batchOutput);
+            if (!outFile.is_open())
+            {
+                cerr << "Unable to open file: " << batchOutput << endl;
+                return 1;
+            }
+        }
+        BatchRunner runner(network, batchOutput.empty() ? cout : outFile);
+        runner.run(batchInput == "-" ? cin : inFile);
+        return 0;
+    }
 
     SocialNetwork socialNetwork;
     string filename;
@@ -843,9 +9284,35 @@ int main() {
         cout << "13. Store Graph Details in File\n";
         cout << "14. Detect Negative Influence Paths\n";
         cout << "15. Find Minimum Spanning Tree or shortest path to someone\n";
-        cout << "16. Exit\n";
+        cout << "16. Open Persistent Store\n";
+        cout << "17. Compact Mutation Log\n";
+        cout << "18. Configure Analysis Cache\n";
+        cout << "19. Dynamic Centrality\n";
+        cout << "20. Compressed Adjacency\n";
+        cout << "21. Out-of-Core Analysis\n";
+        cout << "22. Multi-Process Analysis\n";
+        cout << "23. Degrees of Separation\n";
+        cout << "24. Distance Oracle\n";
+        cout << "25. Connected Components\n";
+        cout << "26. Filter Members by Role and Interest\n";
+        cout << "27. Benchmark Graph Specializations\n";
+        cout << "28. Background Jobs\n";
+        cout << "29. Temporal Analysis\n";
+        cout << "30. Recommend Connections\n";
+        cout << "31. Exit\n";
         cout << "Enter your choice: ";
-        cin >> choice;
+        if (!(cin >> choice))
+        {
+            if (cin.eof())
+            {
+                break;
+            }
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            cout << "Invalid choice. Please enter a number.\n";
+            continue;
+        }
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
         switch (choice) {
         case 1: {
 
@@ -904,7 +9371,6 @@ int main() {
 
             cout << "Enter event name: ";
             string eventName;
-            cin.ignore();
             getline(cin, eventName);
             socialNetwork.displayEventDetails(eventName);
             break;
@@ -918,13 +9384,12 @@ int main() {
             int numInterests;
 
             cout << "Enter name: ";
-            cin.ignore();
             getline(cin, name);
             cout << "Enter role: ";
             getline(cin, role);
             cout << "Enter number of interests: ";
             cin >> numInterests;
-            cin.ignore();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
 
             for (int i = 0; i < numInterests; ++i)
             {
@@ -950,17 +9415,15 @@ int main() {
             int relationshipType;
 
             cout << "Enter source node: ";
-            cin.ignore();
-            cin >> source;
-            //getline(cin, source);
+            getline(cin, source);
             cout << "Enter destination node: ";
-            cin.ignore();
-            cin >> destination;
-            //getline(cin, destination);
+            getline(cin, destination);
             cout << "Enter weight: ";
             cin >> weight;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
             cout << "Enter relationship type (0-FRIENDSHIP, 1-COLLABORATION, etc.): ";
             cin >> relationshipType;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
 
             socialNetwork.addEdge(source, destination, weight, static_cast<RelationshipType>(relationshipType));
             break;
@@ -971,7 +9434,6 @@ int main() {
         case 11: {
             string name;
             cout << "Enter node name to remove: ";
-            cin.ignore();
             getline(cin, name);
             socialNetwork.removeNode(name);
             break;
@@ -980,10 +9442,8 @@ int main() {
         case 12: {
             string source, destination;
             cout << "Enter source node: ";
-            cin.ignore();
             getline(cin, source);
             cout << "Enter destination node: ";
-            cin.ignore();
             getline(cin, destination);
             socialNetwork.removeEdge(source, destination);
             break;
@@ -993,7 +9453,6 @@ int main() {
         case 13: {
 
             cout << "Enter filename to store graph details: ";
-            cin.ignore();
             getline(cin, filename);
 
             socialNetwork.storeGraphDetailsToFile(filename);
@@ -1005,7 +9464,6 @@ int main() {
         case 14: {
             string sourceNode;
             cout << "Enter source node name to detect negative influence paths: ";
-            cin.ignore();
             getline(cin, sourceNode);
             socialNetwork.detectNegativeInfluencePaths(sourceNode);
             break;
@@ -1014,12 +9472,379 @@ int main() {
         case 15: {
             string startNode;
             cout << "Enter the starting node: ";
-            cin >> startNode;
+            getline(cin, startNode);
             socialNetwork.findMinimumSpanningTree(startNode);
             break;
         }
 
         case 16: {
+            string basePath;
+            cout << "Enter persistent store path: ";
+            getline(cin, basePath);
+            socialNetwork.openPersistentStore(basePath);
+            break;
+        }
+
+        case 17: {
+            socialNetwork.compactMutationLog();
+            break;
+        }
+
+        case 18: {
+            socialNetwork.displayAnalysisCacheStatistics();
+            long long budget;
+            cout << "Enter cache memory budget in bytes (0 for unlimited, -1 to keep current): ";
+            cin >> budget;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            if (budget >= 0)
+            {
+                socialNetwork.setAnalysisCacheBudget(static_cast<size_t>(budget));
+            }
+            break;
+        }
+
+        case 19: {
+            int action;
+            cout << "1. Report  2. Verify against full recomputation  3. Verify after every update  4. Stop verifying after updates  5. Disable\n";
+            cout << "Enter action: ";
+            cin >> action;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            if (action >= 1 && action <= 4)
+            {
+                socialNetwork.enableDynamicCentrality();
+            }
+            if (action == 1)
+            {
+                socialNetwork.displayDynamicCentrality();
+            }
+            else if (action == 2)
+            {
+                socialNetwork.verifyDynamicCentrality();
+            }
+            else if (action == 3 || action == 4)
+            {
+                socialNetwork.setDynamicCentralityVerification(action == 3);
+            }
+            else if (action == 5)
+            {
+                socialNetwork.disableDynamicCentrality();
+            }
+            break;
+        }
+
+        case 20: {
+            char answer;
+            cout << "Use compressed adjacency for BFS analyses? (y/n): ";
+            cin >> answer;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            socialNetwork.setCompressedAdjacency(answer == 'y' || answer == 'Y');
+            socialNetwork.displayCompressionReport();
+            break;
+        }
+
+        case 21: {
+            int action;
+            string directory;
+            cout << "1. Partition current graph  2. Partition graph file  3. Degrees of separation  4. PageRank\n";
+            cout << "Enter action: ";
+            cin >> action;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            cout << "Enter partition directory: ";
+            getline(cin, directory);
+            if (action == 1 || action == 2)
+            {
+                string graphFile;
+                uint32_t partitionCount;
+                if (action == 2)
+                {
+                    cout << "Enter graph file: ";
+                    getline(cin, graphFile);
+                }
+                cout << "Enter number of partitions: ";
+                cin >> partitionCount;
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                if (action == 1)
+                {
+                    socialNetwork.exportPartitions(directory, partitionCount);
+                }
+                else
+                {
+                    socialNetwork.importPartitions(graphFile, directory, partitionCount);
+                }
+            }
+            else if (action == 3)
+            {
+                string sourceNode;
+                cout << "Enter source node: ";
+                getline(cin, sourceNode);
+                socialNetwork.findDegreesOfSeparationOutOfCore(directory, sourceNode);
+            }
+            else if (action == 4)
+            {
+                int iterations;
+                cout << "Enter number of iterations: ";
+                cin >> iterations;
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                socialNetwork.rankByPageRankOutOfCore(directory, iterations, 10);
+            }
+            break;
+        }
+
+        case 22: {
+            int action, scheme;
+            uint32_t workerCount;
+            cout << "1. Highest communication centrality  2. PageRank\n";
+            cout << "Enter action: ";
+            cin >> action;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            cout << "Enter number of worker processes: ";
+            cin >> workerCount;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            cout << "Enter partitioning (1-1D vertex ranges, 2-2D edge grid): ";
+            cin >> scheme;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            PartitioningScheme partitioning = scheme == 2 ? PARTITION_2D : PARTITION_1D;
+            if (action == 1)
+            {
+                socialNetwork.findHighestCentralityDistributed(workerCount, partitioning);
+            }
+            else if (action == 2)
+            {
+                int iterations;
+                cout << "Enter number of iterations: ";
+                cin >> iterations;
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                socialNetwork.rankByPageRankDistributed(workerCount, partitioning, iterations, 10);
+            }
+            break;
+        }
+
+        case 23: {
+            string sourceNode, targetNode;
+            int landmarks;
+            cout << "Enter source node: ";
+            getline(cin, sourceNode);
+            cout << "Enter target node: ";
+            getline(cin, targetNode);
+            cout << "Enter number of landmarks for weighted queries (0 to disable, -1 to keep current): ";
+            cin >> landmarks;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            if (landmarks >= 0)
+            {
+                socialNetwork.setLandmarkCount(static_cast<uint32_t>(landmarks));
+            }
+            socialNetwork.findDegreesOfSeparation(sourceNode, targetNode);
+            break;
+        }
+
+        case 24: {
+            int action;
+            cout << "1. Build  2. Query pair  3. Load from graph file\n";
+            cout << "Enter action: ";
+            cin >> action;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            if (action == 1)
+            {
+                socialNetwork.buildDistanceOracle();
+            }
+            else if (action == 2)
+            {
+                string sourceNode, targetNode;
+                cout << "Enter source node: ";
+                getline(cin, sourceNode);
+                cout << "Enter target node: ";
+                getline(cin, targetNode);
+                socialNetwork.displayOracleDistance(sourceNode, targetNode);
+            }
+            else if (action == 3)
+            {
+                cout << "Enter graph filename: ";
+                getline(cin, filename);
+                socialNetwork.loadDistanceOracle(filename);
+            }
+            break;
+        }
+
+        case 25: {
+            socialNetwork.displayConnectedComponents();
+            break;
+        }
+
+        case 26: {
+            string role, interest;
+            cout << "Enter role (empty for any): ";
+            getline(cin, role);
+            cout << "Enter interest (empty for any): ";
+            getline(cin, interest);
+            socialNetwork.findMembersByAttributes(role, interest);
+            socialNetwork.displayAttributeStorageReport();
+            break;
+        }
+
+        case 27: {
+            uint32_t sourceCount;
+            cout << "Enter number of BFS sources: ";
+            cin >> sourceCount;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            socialNetwork.benchmarkGraphSpecializations(sourceCount);
+            break;
+        }
+
+        case 28: {
+            int action;
+            cout << "1. Submit analysis  2. List jobs  3. Cancel job  4. Show job result\n";
+            cout << "Enter action: ";
+            cin >> action;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            if (action == 1)
+            {
+                int analysis;
+                const char* analyses[] = { "centrality", "communities", "betweenness", "negative-paths", "components",
+                    "recommendations" };
+                cout << "1. Highest centrality  2. Collaboration networks  3. Betweenness centrality  "
+                    << "4. Negative influence paths  5. Connected components  6. Recommendations for a role\n";
+                cout << "Enter analysis: ";
+                cin >> analysis;
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                if (analysis < 1 || analysis > 6)
+                {
+                    cout << "Invalid analysis.\n";
+                    break;
+                }
+                string argument;
+                if (analysis == 4)
+                {
+                    cout << "Enter source node: ";
+                    getline(cin, argument);
+                }
+                else if (analysis == 6)
+                {
+                    cout << "Enter role (empty for Student): ";
+                    getline(cin, argument);
+                }
+                uint64_t id = socialNetwork.submitAnalysisJob(analyses[analysis - 1], argument);
+                cout << "Submitted job " << id << ".\n";
+            }
+            else if (action == 2)
+            {
+                socialNetwork.displayJobs();
+            }
+            else if (action == 3 || action == 4)
+            {
+                uint64_t id;
+                cout << "Enter job id: ";
+                cin >> id;
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                if (action == 3)
+                {
+                    cout << (socialNetwork.cancelJob(id) ? "Cancellation requested.\n" : "Job not found.\n");
+                }
+                else
+                {
+                    socialNetwork.displayJobResult(id);
+                }
+            }
+            break;
+        }
+
+        case 29: {
+            int action;
+            cout << "1. Add temporal relationship  2. Set time window  3. Window report  "
+                << "4. Reachable in window  5. Earliest-arrival path\n";
+            cout << "Enter action: ";
+            cin >> action;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            if (action == 1)
+            {
+                string source, destination, validFrom, validUntil;
+                double weight;
+                int type;
+                cout << "Enter source node: ";
+                getline(cin, source);
+                cout << "Enter destination node: ";
+                getline(cin, destination);
+                cout << "Enter weight: ";
+                cin >> weight;
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                cout << "Enter relationship type (0: Friendship, 1: Collaboration, 2: Mentorship, 3: Project Collaboration, 4: Academic Advising): ";
+                cin >> type;
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                cout << "Valid from (YYYY-MM-DD, empty for always): ";
+                getline(cin, validFrom);
+                cout << "Valid until (YYYY-MM-DD, empty for open): ";
+                getline(cin, validUntil);
+
+                Timestamp from = TIME_MIN;
+                Timestamp until = TIME_MAX;
+                if (type < 0 || type >= NUM_RELATIONSHIPS || (!validFrom.empty() && !parseDate(validFrom, from))
+                    || (!validUntil.empty() && !parseDate(validUntil, until)))
+                {
+                    cout << "Invalid relationship type or date.\n";
+                    break;
+                }
+                socialNetwork.addEdge(source, destination, weight, static_cast<RelationshipType>(type), from, until);
+            }
+            else if (action == 2)
+            {
+                string startDate, endDate;
+                cout << "Window start (YYYY-MM-DD, empty for open): ";
+                getline(cin, startDate);
+                cout << "Window end (YYYY-MM-DD, exclusive, empty for open): ";
+                getline(cin, endDate);
+                socialNetwork.setTimeWindow(startDate, endDate);
+            }
+            else if (action == 3)
+            {
+                socialNetwork.displayWindowReport();
+            }
+            else if (action == 4 || action == 5)
+            {
+                string source, target;
+                cout << "Enter source node: ";
+                getline(cin, source);
+                if (action == 4)
+                {
+                    socialNetwork.findReachableInWindow(source);
+                }
+                else
+                {
+                    cout << "Enter target node: ";
+                    getline(cin, target);
+                    socialNetwork.findTemporalPath(source, target);
+                }
+            }
+            break;
+        }
+
+        case 30: {
+            int action;
+            size_t topCount;
+            double budget;
+            string target;
+            cout << "1. Recommend for one individual  2. Recommend for everyone with a role\n";
+            cout << "Enter action: ";
+            cin >> action;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            cout << (action == 1 ? "Enter node name: " : "Enter role (e.g. Student): ");
+            getline(cin, target);
+            cout << "Enter number of suggestions: ";
+            cin >> topCount;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            cout << "Enter time budget per individual (ms): ";
+            cin >> budget;
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            if (action == 1)
+            {
+                socialNetwork.recommendConnections(target, topCount, budget);
+            }
+            else if (action == 2)
+            {
+                socialNetwork.recommendConnectionsForRole(target, topCount, budget);
+            }
+            break;
+        }
+
+        case 31: {
             exitMenu = true;
             break;
         }
@@ -1029,6 +9854,9 @@ int main() {
             break;
         }
         }
+        socialNetwork.commitMutations();
+        socialNetwork.publishSnapshot();
+        socialNetwork.refreshLandmarkIndex();
     }
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+#!/bin/sh
+# Golden-output tests for batch mode.
+#
+# Every directory under tests/ is one scenario. Its numbered *.txt command files
+# run in order with --batch, sharing one scratch directory, so a later file can
+# load what an earlier one stored. Any *.graph fixture in the scenario is copied
+# into the scratch directory first. The output of each file, with timings
+# replaced by N, must match the .expected file next to it.
+#
+# Usage: tests/run_tests.sh [--update]
+#   --update rewrites the .expected files from the current output.
+
+set -u
+
+testDir=$(cd "$(dirname "$0")" && pwd)
+repoDir=$(dirname "$testDir")
+workDir=$(mktemp -d)
+trap 'rm -rf "$workDir"' EXIT
+
+update=0
+if [ "${1:-}" = "--update" ]; then
+    update=1
+fi
+
+program="$workDir/Source"
+if ! ${CXX:-g++} -std=c++17 -O2 -pthread -o "$program" "$repoDir/Source.cpp"; then
+    echo "Build failed."
+    exit 1
+fi
+
+normalize() {
+    sed -e 's/"elapsedMs":[0-9.e+-]*/"elapsedMs":N/g' \
+        -e 's/\([( ]\)[0-9][0-9.e+-]* \(ms\|us\)\b/\1N \2/g' \
+        -e 's/ in [0-9][0-9.e+-]* s\b/ in N s/g'
+}
+
+failures=0
+total=0
+for scenario in "$testDir"/*/; do
+    name=$(basename "$scenario")
+    scratch="$workDir/$name"
+    mkdir -p "$scratch"
+    for fixture in "$scenario"*.graph; do
+        [ -e "$fixture" ] && cp "$fixture" "$scratch/"
+    done
+
+    for script in "$scenario"*.txt; do
+        total=$((total + 1))
+        expected="${script%.txt}.expected"
+        actual="$workDir/actual"
+        (cd "$scratch" && "$program" --batch "$script") 2>&1 | normalize > "$actual"
+
+        if [ "$update" -eq 1 ]; then
+            cp "$actual" "$expected"
+            echo "updated $name/$(basename "$expected")"
+        elif diff -u "$expected" "$actual" > "$workDir/diff" 2>&1; then
+            echo "ok      $name/$(basename "$script")"
+        else
+            failures=$((failures + 1))
+            echo "FAILED  $name/$(basename "$script")"
+            cat "$workDir/diff"
+        fi
+    done
+done
+
+if [ "$update" -eq 0 ]; then
+    echo "$((total - failures)) of $total passed."
+fi
+[ "$failures" -eq 0 ]